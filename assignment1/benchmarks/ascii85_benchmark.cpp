@@ -0,0 +1,177 @@
+#include <benchmark/benchmark.h>
+#include "ascii85.hpp"
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ascii85;
+
+// Throughput benchmarks for the ASCII85 codec. Every benchmark reports
+// bytes_per_second over the raw (binary) side of the data, so encode and
+// decode numbers are directly comparable. For a machine-readable report run
+//
+//   ascii85_benchmark --benchmark_out=report.json --benchmark_out_format=json
+//
+// and restrict the sweep with --benchmark_filter (e.g. '/1048576$').
+
+namespace {
+
+enum Shape {
+    RANDOM, // uniformly random bytes
+    ZEROS,  // all zero, every group collapses to 'z'
+    TEXT    // printable text, encoded output wrapped at 76 columns
+};
+
+const char* const SHAPE_NAMES[] = {"random", "zeros", "text"};
+
+constexpr int64_t MIN_SIZE = 64;
+constexpr int64_t MAX_SIZE = int64_t(1) << 30;
+
+std::string makeBinary(Shape shape, size_t size) {
+    std::string data(size, '\0');
+    std::mt19937_64 gen(size);
+    if (shape == RANDOM) {
+        for (auto& c : data) {
+            c = static_cast<char>(gen());
+        }
+    } else if (shape == TEXT) {
+        static const char words[] = "the quick brown fox jumps over the lazy dog\n";
+        for (size_t i = 0; i < size; i++) {
+            data[i] = words[(i + gen() % 3) % (sizeof(words) - 1)];
+        }
+    }
+    return data;
+}
+
+// Inputs are expensive to build at the large end, so each one is made once
+const std::string& binaryInput(Shape shape, size_t size) {
+    static std::map<std::pair<int, size_t>, std::string> cache;
+    auto key = std::make_pair(static_cast<int>(shape), size);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, makeBinary(shape, size)).first;
+    }
+    return it->second;
+}
+
+const std::string& encodedInput(Shape shape, size_t size) {
+    static std::map<std::pair<int, size_t>, std::string> cache;
+    auto key = std::make_pair(static_cast<int>(shape), size);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        EncodeOptions options;
+        options.lineWidth = shape == TEXT ? 76 : 0;
+        it = cache.emplace(key, ASCII85::encode(binaryInput(shape, size), options)).first;
+    }
+    return it->second;
+}
+
+// Read-only streambuf over existing memory, so stream benchmarks do not
+// pay for copying the input into a stringstream
+class MemoryBuffer : public std::streambuf {
+public:
+    MemoryBuffer(const std::string& data) {
+        char* begin = const_cast<char*>(data.data());
+        setg(begin, begin, begin + data.size());
+    }
+};
+
+// Output streambuf that discards everything
+class NullBuffer : public std::streambuf {
+protected:
+    int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+void setup(benchmark::State& state, Shape shape) {
+    state.SetLabel(SHAPE_NAMES[shape]);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_Encode(benchmark::State& state, Shape shape) {
+    const std::string& input = binaryInput(shape, state.range(0));
+    std::vector<char> output(ASCII85::encodedSizeBound(input.size()));
+    for (auto _ : state) {
+        size_t written = ASCII85::encode(reinterpret_cast<const uint8_t*>(input.data()),
+                                         input.size(), output.data());
+        benchmark::DoNotOptimize(written);
+        benchmark::ClobberMemory();
+    }
+    setup(state, shape);
+}
+
+void BM_Decode(benchmark::State& state, Shape shape) {
+    const std::string& input = encodedInput(shape, state.range(0));
+    std::vector<uint8_t> output(state.range(0) + 4);
+    for (auto _ : state) {
+        // decode() needs decodedSizeBound(); the incremental decoder writes
+        // only what the input actually holds
+        ASCII85::Decoder decoder;
+        size_t written = decoder.feed(input.data(), input.size(), output.data());
+        written += decoder.finish(output.data() + written);
+        benchmark::DoNotOptimize(written);
+        benchmark::ClobberMemory();
+    }
+    setup(state, shape);
+}
+
+void BM_ProcessStream(benchmark::State& state, Shape shape, bool decode) {
+    const std::string& data = decode ? encodedInput(shape, state.range(0))
+                                     : binaryInput(shape, state.range(0));
+    NullBuffer sink;
+    std::ostream output(&sink);
+    for (auto _ : state) {
+        MemoryBuffer source(data);
+        std::istream input(&source);
+        ASCII85::processStream(input, output, decode);
+    }
+    setup(state, shape);
+}
+
+void BM_ProcessBuffer(benchmark::State& state, Shape shape, bool decode) {
+    const std::string& data = decode ? encodedInput(shape, state.range(0))
+                                     : binaryInput(shape, state.range(0));
+    NullBuffer sink;
+    std::ostream output(&sink);
+    for (auto _ : state) {
+        ASCII85::processBuffer(data, output, decode);
+    }
+    setup(state, shape);
+}
+
+void registerAll() {
+    for (Shape shape : {RANDOM, ZEROS, TEXT}) {
+        std::string suffix = std::string("/") + SHAPE_NAMES[shape];
+        std::vector<benchmark::internal::Benchmark*> benchmarks = {
+            benchmark::RegisterBenchmark(("Encode" + suffix).c_str(), BM_Encode, shape),
+            benchmark::RegisterBenchmark(("Decode" + suffix).c_str(), BM_Decode, shape),
+            benchmark::RegisterBenchmark(("ProcessStream/encode" + suffix).c_str(),
+                                         BM_ProcessStream, shape, false),
+            benchmark::RegisterBenchmark(("ProcessStream/decode" + suffix).c_str(),
+                                         BM_ProcessStream, shape, true),
+            benchmark::RegisterBenchmark(("ProcessBuffer/encode" + suffix).c_str(),
+                                         BM_ProcessBuffer, shape, false),
+            benchmark::RegisterBenchmark(("ProcessBuffer/decode" + suffix).c_str(),
+                                         BM_ProcessBuffer, shape, true),
+        };
+        for (auto* bench : benchmarks) {
+            bench->RangeMultiplier(16)->Range(MIN_SIZE, MAX_SIZE);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    registerAll();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
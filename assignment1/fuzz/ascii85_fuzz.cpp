@@ -0,0 +1,25 @@
+#include "differential.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// libFuzzer entry point: the input is taken both as data to encode and as
+// text to decode, on every variant and every codec path, and any
+// disagreement with the reference codec aborts with a description
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string input(reinterpret_cast<const char*>(data), size);
+
+    // The chunk splits and line width follow from the input itself, so a
+    // crash reproduces from the saved input alone
+    uint64_t seed = size;
+    for (size_t i = 0; i < size && i < 8; i++) {
+        seed = seed * 131 + data[i];
+    }
+
+    std::string failure = ascii85::differential::checkAll(input, seed);
+    if (!failure.empty()) {
+        std::fprintf(stderr, "%s\n", failure.c_str());
+        std::abort();
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// Stands in for libFuzzer where it is not available (e.g. GCC builds):
+// runs the fuzz target once on every file named on the command line, so a
+// corpus or a crash input can be replayed in any build
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "Cannot open %s\n", argv[i]);
+            return 1;
+        }
+        std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+    }
+    std::fprintf(stderr, "Replayed %d inputs\n", argc - 1);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace ascii85 {
+
+// Adobe ASCII85 uses characters starting with '!' (33) and ending with 'u' (117)
+constexpr char ADOBE_ALPHABET[] =
+    "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstu";
+
+// ZeroMQ Z85 (RFC 32), safe inside source code and XML
+constexpr char Z85_ALPHABET[] =
+    "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.-:+=^!/*?&<>()[]{}@%$#";
+
+// RFC 1924 digits, as used by git binary patches and Python's b85encode
+constexpr char RFC1924_ALPHABET[] =
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz!#$%&()*+-;<=>?@^_`{|}~";
+
+// Decoding table entries hold the digit value (0-84) of alphabet chars;
+// every other char gets NOT_DIGIT plus exactly one class bit
+constexpr uint8_t NOT_DIGIT = 0x80;
+constexpr uint8_t WHITESPACE = 0x40;
+constexpr uint8_t ZERO_GROUP = 0x20;
+constexpr uint8_t INVALID = 0x10;
+constexpr uint8_t FRAME_END = 0x08;
+constexpr uint8_t SPACE_GROUP = 0x04;
+
+// Builds the decoding table of an 85-char alphabet. `zeroChar` and
+// `spaceChar` stand for a group of four zero bytes and four spaces (0 =
+// no such shortcut), `frames` makes '~' the start of the "~>" end marker.
+// Control chars and space are whitespace.
+constexpr std::array<uint8_t, 256> makeDecodingTable(const char* alphabet, char zeroChar = 'z',
+                                                     char spaceChar = 0, bool frames = true) {
+    std::array<uint8_t, 256> table{};
+    for (int c = 0; c < 256; c++) {
+        table[c] = NOT_DIGIT | (c <= ' ' ? WHITESPACE : INVALID);
+    }
+    if (zeroChar != 0) {
+        table[static_cast<unsigned char>(zeroChar)] = NOT_DIGIT | ZERO_GROUP;
+    }
+    if (spaceChar != 0) {
+        table[static_cast<unsigned char>(spaceChar)] = NOT_DIGIT | SPACE_GROUP;
+    }
+    if (frames) {
+        table['~'] = NOT_DIGIT | FRAME_END;
+    }
+    for (int i = 0; i < 85; i++) {
+        table[static_cast<unsigned char>(alphabet[i])] = static_cast<uint8_t>(i);
+    }
+    return table;
+}
+
+// Variants of base-85, the template argument of Base85. Each one names
+// its digits, its shortcut chars (0 = none), whether a final group may be
+// partial (n bytes as n + 1 chars) and whether the Adobe "<~" and "~>"
+// delimiters apply.
+namespace alphabet {
+
+// Adobe ASCII85 (PostScript, PDF)
+struct Adobe {
+    static constexpr const char* NAME = "ascii85";
+    static constexpr const char* DIGITS = ADOBE_ALPHABET;
+    static constexpr char ZERO_CHAR = 'z';
+    static constexpr char SPACE_CHAR = 0;
+    static constexpr bool PARTIAL_GROUPS = true;
+    static constexpr bool FRAMES = true;
+};
+
+// btoa 4.2: Adobe digits plus 'y' for four spaces. The "xbtoa" header and
+// checksum lines are not part of the codec.
+struct Btoa {
+    static constexpr const char* NAME = "btoa";
+    static constexpr const char* DIGITS = ADOBE_ALPHABET;
+    static constexpr char ZERO_CHAR = 'z';
+    static constexpr char SPACE_CHAR = 'y';
+    static constexpr bool PARTIAL_GROUPS = true;
+    static constexpr bool FRAMES = false;
+};
+
+// Z85: data must be a multiple of 4 bytes, text a multiple of 5 chars
+struct Z85 {
+    static constexpr const char* NAME = "z85";
+    static constexpr const char* DIGITS = Z85_ALPHABET;
+    static constexpr char ZERO_CHAR = 0;
+    static constexpr char SPACE_CHAR = 0;
+    static constexpr bool PARTIAL_GROUPS = false;
+    static constexpr bool FRAMES = false;
+};
+
+// RFC 1924 digits over 4-byte groups, the way git and Python use them
+// (not the RFC's single 128-bit number for IPv6 addresses)
+struct Rfc1924 {
+    static constexpr const char* NAME = "rfc1924";
+    static constexpr const char* DIGITS = RFC1924_ALPHABET;
+    static constexpr char ZERO_CHAR = 0;
+    static constexpr char SPACE_CHAR = 0;
+    static constexpr bool PARTIAL_GROUPS = true;
+    static constexpr bool FRAMES = false;
+};
+
+} // namespace alphabet
+
+// Decoding table of a variant
+template <typename Alphabet>
+constexpr std::array<uint8_t, 256> DECODING_TABLE_OF =
+    makeDecodingTable(Alphabet::DIGITS, Alphabet::ZERO_CHAR, Alphabet::SPACE_CHAR, Alphabet::FRAMES);
+
+} // namespace ascii85
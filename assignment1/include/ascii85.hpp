@@ -1,38 +1,485 @@
 #pragma once
 
+#include <array>
 #include <string>
 #include <vector>
 #include <iostream>
+#include <stdexcept>
 #include <cstdint>
+#include <cstddef>
+#include "alphabet.hpp"
+#include "ascii85_simd.hpp"
+#include "crc32c.hpp"
+#include "stats.hpp"
 
 namespace ascii85 {
 
-class ASCII85 {
+// Layout of encoded output
+struct EncodeOptions {
+    // Enclose the output in the Adobe "<~" and "~>" delimiters (only for
+    // variants that have them)
+    bool frame = false;
+
+    // Break the output into lines of this many chars (0 = no breaks). The
+    // delimiters count towards the width but are never split, so framed
+    // output is at least 2 columns wide. No newline follows the last line.
+    size_t lineWidth = 0;
+
+    // When decoding: the text is known to come from this encoder (e.g. it
+    // was written by ourselves), so the groups are not validated; only the
+    // delimiters and the trailing group still are. Nothing is read or
+    // written out of bounds, but malformed groups decode to unspecified
+    // bytes instead of raising an error.
+    bool trusted = false;
+
+    // Line width in effect
+    constexpr size_t effectiveLineWidth() const {
+        return frame && lineWidth == 1 ? 2 : lineWidth;
+    }
+};
+
+// How process() reads its input: block by block, or all of it at once
+enum class Mode {
+    STREAM,
+    BUFFER
+};
+
+// Base-85 codec over one of the variants in alphabet.hpp. All variants
+// share the vector kernels, the streaming and the parallel paths; the
+// class is instantiated in the library for each of them.
+template <typename Alphabet>
+class Base85 {
 public:
-    enum class Mode {
-        STREAM,
-        BUFFER
-    };
+    using Mode = ascii85::Mode;
+
+    // Default read block size of the stream mode
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 65536;
+
+    // Default number of blocks in flight in processPipeline()
+    static constexpr size_t DEFAULT_PIPELINE_DEPTH = 8;
 
     // Encode binary data to ASCII85
     static std::string encode(const std::string& input);
+
+    // Encode `length` bytes from `input` directly into `output`, which must
+    // hold at least encodedSizeBound(length) chars. Returns the number of
+    // chars written. Variants without partial groups (Z85) throw
+    // std::invalid_argument unless `length` is a multiple of 4.
+    static size_t encode(const uint8_t* input, size_t length, char* output);
+
+    // Upper bound on the encoded size of `length` input bytes
+    static constexpr size_t encodedSizeBound(size_t length) {
+        return length / 4 * 5 + (length % 4 ? length % 4 + 1 : 0);
+    }
+
+    // Encode with framing and line breaks. Line breaks are placed while
+    // encoding, so the output needs no second pass.
+    static std::string encode(const std::string& input, const EncodeOptions& options);
+    static size_t encode(const uint8_t* input, size_t length, char* output,
+                         const EncodeOptions& options);
+
+    // Upper bound on the encoded size of `length` input bytes, delimiters
+    // and line breaks included
+    static constexpr size_t encodedSizeBound(size_t length, const EncodeOptions& options) {
+        size_t text = encodedSizeBound(length) + (options.frame ? 4 : 0);
+        size_t width = options.effectiveLineWidth();
+        return text + (width != 0 ? text / width + 1 : 0);
+    }
     
-    // Decode ASCII85 to binary data
-    static std::string decode(const std::string& input);
+    // Decode ASCII85 to binary data. Adobe delimiters are optional: a
+    // leading "<~" is skipped and "~>" ends the data (only whitespace may
+    // follow it). Other variants have no delimiters. A `trusted` decode
+    // skips validation (see EncodeOptions::trusted).
+    static std::string decode(const std::string& input, bool trusted = false);
+
+    // Decode `length` chars from `input` directly into `output`, which must
+    // hold at least decodedSizeBound(length) bytes. Returns the number of
+    // bytes written.
+    static size_t decode(const char* input, size_t length, uint8_t* output, bool trusted = false);
+
+    // Upper bound on the decoded size of `length` input chars
+    // (a lone shortcut expands to 4 bytes)
+    static constexpr size_t decodedSizeBound(size_t length) {
+        return length * 4;
+    }
     
-    // Process input stream in stream mode
-    static void processStream(std::istream& input, std::ostream& output, bool decode = false);
+    // Multi-threaded encode on `threads` threads (0 = one per hardware
+    // thread). Produces exactly what encode() produces. The input is added
+    // to `checksum`, if given, by the threads that encode it.
+    static std::string encodeParallel(const std::string& input, size_t threads = 0,
+                                      const EncodeOptions& options = EncodeOptions(),
+                                      Crc32c* checksum = nullptr);
+    static size_t encodeParallel(const uint8_t* input, size_t length, char* output,
+                                 size_t threads = 0,
+                                 const EncodeOptions& options = EncodeOptions(),
+                                 Crc32c* checksum = nullptr);
+
+    // Multi-threaded decode on `threads` threads (0 = one per hardware
+    // thread). Produces exactly what decode() produces. The output is added
+    // to `checksum`, if given, by the threads that decode it, and the number
+    // of shortcut chars decoded to `shortcuts`, if given.
+    static std::string decodeParallel(const std::string& input, size_t threads = 0,
+                                      Crc32c* checksum = nullptr, bool trusted = false,
+                                      uint64_t* shortcuts = nullptr);
+    static size_t decodeParallel(const char* input, size_t length, uint8_t* output,
+                                 size_t threads = 0, Crc32c* checksum = nullptr,
+                                 bool trusted = false, uint64_t* shortcuts = nullptr);
+
+    // With a checksum, data is encoded or decoded in slices of this many
+    // bytes and each slice is summed right after, while it is still in cache
+    static constexpr size_t CHECKSUM_SLICE = 1 << 16;
+
+    // Inputs below this size are not worth splitting across threads
+    static constexpr size_t MIN_PARALLEL_SIZE = 1 << 20;
+
+    // Incremental encoder that carries the 0-3 bytes of an unfinished group
+    // and the current line position across update() calls, so input can
+    // arrive in blocks of any size
+    class Encoder {
+    public:
+        // Start a new output, or continue one whose current line already
+        // holds `column` chars (its frame, if any, is then already open).
+        // Throws std::invalid_argument for a frame the variant does not have.
+        explicit Encoder(const EncodeOptions& options = EncodeOptions(), size_t column = 0);
+
+        // Encode `length` bytes into `output`, which must hold at least
+        // encodedSizeBound(length + 3, options) chars. Returns the number
+        // of chars written.
+        size_t update(const uint8_t* input, size_t length, char* output);
+
+        // Flush the trailing partial group and close the frame into
+        // `output` (at most encodedSizeBound(3, options) chars), then reset
+        // the encoder. Returns the number of chars written.
+        size_t finish(char* output);
+
+        // Add every input byte to `checksum` (nullptr = none) as it is
+        // encoded. The checksum belongs to the caller and outlives finish().
+        void setChecksum(Crc32c* checksum) { this->checksum = checksum; }
+
+    private:
+        // Write chars, breaking lines where needed
+        void put(const char* chars, size_t count, char*& out);
+
+        // Encode whole groups, breaking lines where needed
+        void encodeGroups(const uint8_t* input, size_t length, char*& out);
+
+        void sum(const uint8_t* data, size_t length) {
+            if (checksum != nullptr) {
+                checksum->update(data, length);
+            }
+        }
+
+        EncodeOptions options;
+        size_t column;
+        bool opened;
+        uint8_t pending[4] = {0};
+        size_t pendingCount = 0;
+        Crc32c* checksum = nullptr;
+    };
+
+    // Incremental decoder that carries an unfinished group and the state of
+    // the delimiters across feed() calls, so input can arrive in blocks of
+    // any size
+    class Decoder {
+    public:
+        // A `trusted` decoder skips validation (see EncodeOptions::trusted)
+        explicit Decoder(bool trusted = false) : trusted(trusted) {}
+
+        // Decode `length` chars into `output`, which must hold at least
+        // decodedSizeBound(length) bytes. Returns the number of bytes written.
+        size_t feed(const char* input, size_t length, uint8_t* output);
+
+        // Flush the trailing partial group into `output` (at most 4 bytes)
+        // and reset the decoder. Returns the number of bytes written.
+        size_t finish(uint8_t* output);
+
+        // Add every output byte to `checksum` (nullptr = none) as it is
+        // decoded. The checksum belongs to the caller and outlives finish().
+        void setChecksum(Crc32c* checksum) { this->checksum = checksum; }
+
+        // Shortcut chars decoded since construction, for the statistics
+        uint64_t shortcuts() const { return state.shortcuts; }
+
+    private:
+        // Where the input stands relative to the "<~" and "~>" delimiters
+        enum class Frame {
+            START,   // only whitespace so far
+            OPENING, // '<' seen, a '~' makes it a delimiter
+            BODY,
+            CLOSING, // '~' seen, must be followed by '>'
+            CLOSED
+        };
+
+        static constexpr Frame INITIAL_FRAME = Alphabet::FRAMES ? Frame::START : Frame::BODY;
+
+        // Decode up to the '~' of an end marker, summing slice by slice
+        size_t decodeBody(const char* input, size_t length, uint8_t*& out);
+
+        bool trusted;
+        simd::DecodeState state;
+        Frame frame = INITIAL_FRAME;
+        Crc32c* checksum = nullptr;
+    };
+
+    // Process input stream in stream mode, reading blocks of `blockSize` bytes
+    // (`options` apply to encoding). The binary side, input when encoding and
+    // output when decoding, is added to `checksum` if one is given, and the
+    // counters in `stats` are filled in if it is given; the same holds for
+    // all the process functions below.
+    static void processStream(std::istream& input, std::ostream& output, bool decode = false,
+                              size_t blockSize = DEFAULT_BLOCK_SIZE,
+                              const EncodeOptions& options = EncodeOptions(),
+                              Crc32c* checksum = nullptr, Stats* stats = nullptr);
+    
+    // Stream mode on file descriptors through read(2)/write(2), bypassing
+    // iostreams. A terminal input is encoded line by line.
+    static void processStream(int inputFd, int outputFd, bool decode = false,
+                              size_t blockSize = DEFAULT_BLOCK_SIZE,
+                              const EncodeOptions& options = EncodeOptions(),
+                              Crc32c* checksum = nullptr, Stats* stats = nullptr);
     
-    // Process input stream in buffer mode
-    static void processBuffer(const std::string& data, std::ostream& output, bool decode = false);
+    // Stream mode as a pipeline: a reader thread, codec workers and a
+    // writer thread pass `depth` reusable blocks of `blockSize` bytes
+    // around over lock-free rings, so reading, coding and writing overlap.
+    // Plain encoding (no frame, no line breaks) spreads the blocks over
+    // `workers` threads (0 = one per hardware thread); decoding and
+    // wrapped encoding carry state from block to block and use one.
+    // Output order is always the input order. A terminal input falls back
+    // to processStream().
+    static void processPipeline(int inputFd, int outputFd, bool decode = false,
+                                size_t blockSize = DEFAULT_BLOCK_SIZE, size_t workers = 1,
+                                size_t depth = DEFAULT_PIPELINE_DEPTH,
+                                const EncodeOptions& options = EncodeOptions(),
+                                Crc32c* checksum = nullptr, Stats* stats = nullptr);
     
+    // Process input stream in buffer mode on `threads` threads
+    static void processBuffer(const std::string& data, std::ostream& output, bool decode = false,
+                              size_t threads = 1, const EncodeOptions& options = EncodeOptions(),
+                              Crc32c* checksum = nullptr, Stats* stats = nullptr);
+
+    // Buffer mode writing to a file descriptor through write(2)
+    static void processBuffer(const std::string& data, int outputFd, bool decode = false,
+                              size_t threads = 1, const EncodeOptions& options = EncodeOptions(),
+                              Crc32c* checksum = nullptr, Stats* stats = nullptr);
+    
+    // Encode or decode a file into another through memory mappings. The
+    // output is sized from the size bound, filled in place and then
+    // truncated to the bytes actually written.
+    static void processFile(const std::string& inputPath, const std::string& outputPath,
+                            bool decode = false, size_t threads = 1,
+                            const EncodeOptions& options = EncodeOptions(),
+                            Crc32c* checksum = nullptr, Stats* stats = nullptr);
+
+    // Encode every file into `<file>.a85`, or decode every `<file>.a85`
+    // back into `<file>`, on `threads` workers (0 = one per hardware
+    // thread). Each worker reuses its stream buffers from file to file. A
+    // failed file does not stop the others; returns one "path: error"
+    // message per failed file, in input order.
+    static std::vector<std::string> processFiles(const std::vector<std::string>& paths,
+                                                 bool decode = false, size_t threads = 0,
+                                                 size_t blockSize = DEFAULT_BLOCK_SIZE,
+                                                 const EncodeOptions& options = EncodeOptions(),
+                                                 Stats* stats = nullptr);
+
     // Process input stream with specified mode
-    static void process(std::istream& input, std::ostream& output, Mode mode, bool decode = false);
+    // (`threads` applies to buffer mode)
+    static void process(std::istream& input, std::ostream& output, Mode mode, bool decode = false,
+                        size_t blockSize = DEFAULT_BLOCK_SIZE, size_t threads = 1,
+                        const EncodeOptions& options = EncodeOptions(),
+                        Crc32c* checksum = nullptr, Stats* stats = nullptr);
+
+    // Process file descriptors with specified mode (what the command-line
+    // tool uses for STDIN/STDOUT and -i/-o files)
+    static void process(int inputFd, int outputFd, Mode mode, bool decode = false,
+                        size_t blockSize = DEFAULT_BLOCK_SIZE, size_t threads = 1,
+                        const EncodeOptions& options = EncodeOptions(),
+                        Crc32c* checksum = nullptr, Stats* stats = nullptr);
 
     // Encoding/decoding tables
-    static const char* ENCODING_TABLE;
-    static uint8_t DECODING_TABLE[256];
-    static const uint32_t powers[5];
+    static constexpr const char* ENCODING_TABLE = Alphabet::DIGITS;
+    static constexpr std::array<uint8_t, 256> DECODING_TABLE = DECODING_TABLE_OF<Alphabet>;
+    static constexpr uint32_t powers[5] = {85*85*85*85, 85*85*85, 85*85, 85, 1};
+
+    // Compile-time codec, for embedding binary assets as ASCII85 literals.
+    // The result size depends on the contents (shortcuts, whitespace), so it is
+    // computed first and passed as the array size:
+    //
+    //   constexpr auto blob = ASCII85_DECODE("<~87cURD]i,\"Ebo7~>");
+    //   constexpr auto text = ASCII85::encodeStatic<ASCII85::encodedSize(blob)>(blob);
+    //
+    // Malformed input fails to compile (the error is thrown during constant
+    // evaluation). Called at run time they behave like encode()/decode().
+
+    // Encode `length` bytes into `output` (nullptr = only count) and return
+    // the number of chars
+    static constexpr size_t encodeConstexpr(const uint8_t* input, size_t length, char* output) {
+        size_t written = 0;
+        for (size_t i = 0; i < length; i += 4) {
+            size_t count = length - i < 4 ? length - i : 4;
+            uint32_t value = 0;
+            for (size_t j = 0; j < 4; j++) {
+                value = value << 8 | (j < count ? input[i + j] : 0);
+            }
+            
+            if (count < 4 && !Alphabet::PARTIAL_GROUPS) {
+                throw std::invalid_argument("Input length must be a multiple of 4");
+            }
+            char shortcut = count < 4 ? 0
+                          : value == 0 ? Alphabet::ZERO_CHAR
+                          : value == 0x20202020 ? Alphabet::SPACE_CHAR
+                          : 0;
+            if (shortcut != 0) {
+                if (output != nullptr) {
+                    output[written] = shortcut;
+                }
+                written++;
+                continue;
+            }
+            for (size_t j = 0; j <= count; j++) {
+                if (output != nullptr) {
+                    output[written] = ENCODING_TABLE[value / powers[j] % 85];
+                }
+                written++;
+            }
+        }
+        return written;
+    }
+
+    // Decode `length` chars into `output` (nullptr = only count) and return
+    // the number of bytes. Accepts whitespace and delimiters like decode().
+    static constexpr size_t decodeConstexpr(const char* input, size_t length, uint8_t* output) {
+        size_t begin = 0;
+        while (begin < length && DECODING_TABLE[static_cast<unsigned char>(input[begin])] ==
+                                     (NOT_DIGIT | WHITESPACE)) {
+            begin++;
+        }
+        if (Alphabet::FRAMES && length - begin >= 2 && input[begin] == '<' &&
+            input[begin + 1] == '~') {
+            begin += 2;
+        }
+        
+        size_t written = 0;
+        uint64_t value = 0;
+        size_t count = 0;
+        for (size_t i = begin; i < length; i++) {
+            uint8_t entry = DECODING_TABLE[static_cast<unsigned char>(input[i])];
+            if (entry == (NOT_DIGIT | WHITESPACE)) {
+                continue;
+            }
+            if (entry == (NOT_DIGIT | INVALID)) {
+                throw std::runtime_error("Invalid ASCII85 input: character out of range");
+            }
+            if (entry == (NOT_DIGIT | FRAME_END)) {
+                if (i + 1 == length || input[i + 1] != '>') {
+                    throw std::runtime_error("Invalid ASCII85 input: character out of range");
+                }
+                for (size_t j = i + 2; j < length; j++) {
+                    if (DECODING_TABLE[static_cast<unsigned char>(input[j])] != (NOT_DIGIT | WHITESPACE)) {
+                        throw std::runtime_error("Invalid ASCII85 input: data after end marker");
+                    }
+                }
+                break;
+            }
+            if (entry == (NOT_DIGIT | ZERO_GROUP) || entry == (NOT_DIGIT | SPACE_GROUP)) {
+                if (count != 0) {
+                    throw std::runtime_error(entry == (NOT_DIGIT | ZERO_GROUP)
+                        ? "Invalid ASCII85 input: 'z' character in wrong context"
+                        : "Invalid ASCII85 input: 'y' character in wrong context");
+                }
+                for (size_t j = 0; j < 4; j++) {
+                    if (output != nullptr) {
+                        output[written] = entry == (NOT_DIGIT | ZERO_GROUP) ? 0 : ' ';
+                    }
+                    written++;
+                }
+                continue;
+            }
+            
+            value += entry * uint64_t(powers[count]);
+            if (++count == 5) {
+                if (value > 0xFFFFFFFF) {
+                    throw std::runtime_error("Invalid ASCII85 input: value overflow");
+                }
+                for (size_t j = 0; j < 4; j++) {
+                    if (output != nullptr) {
+                        output[written] = static_cast<uint8_t>(value >> (24 - 8 * j));
+                    }
+                    written++;
+                }
+                value = 0;
+                count = 0;
+            }
+        }
+        
+        // A final partial group is padded with the highest digit and keeps
+        // count - 1 bytes
+        if (count == 1 || (count > 1 && !Alphabet::PARTIAL_GROUPS)) {
+            throw std::runtime_error("Invalid ASCII85 input: incomplete group");
+        }
+        if (count > 1) {
+            for (size_t j = count; j < 5; j++) {
+                value += 84 * uint64_t(powers[j]);
+            }
+            if (value > 0xFFFFFFFF) {
+                throw std::runtime_error("Invalid ASCII85 input: value overflow");
+            }
+            for (size_t j = 0; j + 1 < count; j++) {
+                if (output != nullptr) {
+                    output[written] = static_cast<uint8_t>(value >> (24 - 8 * j));
+                }
+                written++;
+            }
+        }
+        return written;
+    }
+
+    // Sizes of the compile-time results (string literals without their NUL)
+    template <size_t N>
+    static constexpr size_t encodedSize(const std::array<uint8_t, N>& data) {
+        return encodeConstexpr(data.data(), N, nullptr);
+    }
+
+    template <size_t N>
+    static constexpr size_t decodedSize(const char (&text)[N]) {
+        return decodeConstexpr(text, N - 1, nullptr);
+    }
+
+    template <size_t N>
+    static constexpr size_t decodedSize(const std::array<char, N>& text) {
+        return decodeConstexpr(text.data(), N, nullptr);
+    }
+
+    // Compile-time encode; M must be encodedSize(data)
+    template <size_t M, size_t N>
+    static constexpr std::array<char, M> encodeStatic(const std::array<uint8_t, N>& data) {
+        std::array<char, M> result{};
+        if (encodeConstexpr(data.data(), N, nullptr) != M) {
+            throw std::length_error("ASCII85 encodeStatic: result size is not encodedSize()");
+        }
+        encodeConstexpr(data.data(), N, result.data());
+        return result;
+    }
+
+    // Compile-time decode of a string literal; M must be decodedSize(text)
+    template <size_t M, size_t N>
+    static constexpr std::array<uint8_t, M> decodeStatic(const char (&text)[N]) {
+        std::array<uint8_t, M> result{};
+        if (decodeConstexpr(text, N - 1, nullptr) != M) {
+            throw std::length_error("ASCII85 decodeStatic: result size is not decodedSize()");
+        }
+        decodeConstexpr(text, N - 1, result.data());
+        return result;
+    }
+
+    template <size_t M, size_t N>
+    static constexpr std::array<uint8_t, M> decodeStatic(const std::array<char, N>& text) {
+        std::array<uint8_t, M> result{};
+        if (decodeConstexpr(text.data(), N, nullptr) != M) {
+            throw std::length_error("ASCII85 decodeStatic: result size is not decodedSize()");
+        }
+        decodeConstexpr(text.data(), N, result.data());
+        return result;
+    }
 
 private:
     // Helper functions
@@ -41,4 +488,20 @@ private:
     static bool isValidASCII85(const std::string& data);
 };
 
-} // namespace ascii85 
\ No newline at end of file
+// The variants, all built into the library
+using ASCII85 = Base85<alphabet::Adobe>;
+using Btoa = Base85<alphabet::Btoa>;
+using Z85 = Base85<alphabet::Z85>;
+using RFC1924 = Base85<alphabet::Rfc1924>;
+
+extern template class Base85<alphabet::Adobe>;
+extern template class Base85<alphabet::Btoa>;
+extern template class Base85<alphabet::Z85>;
+extern template class Base85<alphabet::Rfc1924>;
+
+} // namespace ascii85
+
+// Decode an ASCII85 string literal (or constexpr std::array<char, N>) at
+// compile time into a std::array<uint8_t, size>
+#define ASCII85_DECODE(text) \
+    ::ascii85::ASCII85::decodeStatic<::ascii85::ASCII85::decodedSize(text)>(text)
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "alphabet.hpp"
+
+namespace ascii85 {
+namespace simd {
+
+// Every kernel is a template on the base-85 variant (see alphabet.hpp),
+// instantiated for the variants listed there; Adobe ASCII85 is the default.
+// The digit arithmetic is shared, only the mapping between digits and
+// chars and the shortcut groups differ.
+
+// An encoder kernel converts as many whole 4-byte groups as it can handle
+// in bulk, writes them to `output` (advancing it past the chars written)
+// and returns the number of input bytes consumed. The caller encodes the
+// remaining bytes with the scalar reference path.
+using EncodeKernel = size_t (*)(const uint8_t* input, size_t length, char*& output);
+
+// Scalar reference encoder. Consumes the whole input, including a trailing
+// partial group.
+template <typename Alphabet = alphabet::Adobe>
+size_t encodeScalar(const uint8_t* input, size_t length, char*& output);
+
+// Vectorized kernels, 4 groups (SSE4.1) or 8 groups (AVX2) per iteration.
+// They must only be called when the CPU supports the instruction set.
+template <typename Alphabet = alphabet::Adobe>
+size_t encodeSSE41(const uint8_t* input, size_t length, char*& output);
+template <typename Alphabet = alphabet::Adobe>
+size_t encodeAVX2(const uint8_t* input, size_t length, char*& output);
+
+// Digits of a group that is still being collected by the decoder, and
+// the shortcut chars expanded so far (counted where the decoders already
+// tell them apart, for the statistics)
+struct DecodeState {
+    uint8_t digits[5] = {0};
+    int count = 0;
+    uint64_t shortcuts = 0;
+};
+
+// A decoder kernel decodes a prefix of `input` that contains only digits
+// and whitespace, writes whole groups to `output` (advancing it) and leaves
+// the digits of an unfinished group in `state`. It returns the number of
+// input chars consumed and stops early at anything it cannot handle
+// (shortcuts, invalid chars), which the scalar path then takes care of.
+using DecodeKernel = size_t (*)(const char* input, size_t length, uint8_t*& output,
+                                DecodeState& state);
+
+// Scalar reference decoder. Consumes the input up to the first '~' that
+// starts an end marker and returns the number of chars consumed. Throws
+// std::runtime_error on malformed data.
+template <typename Alphabet = alphabet::Adobe>
+size_t decodeScalar(const char* input, size_t length, uint8_t*& output, DecodeState& state);
+
+// Flushes a trailing partial group left in `state`
+template <typename Alphabet = alphabet::Adobe>
+void decodeFinish(DecodeState& state, uint8_t*& output);
+
+// Vectorized kernels: 16-byte classification and whitespace compaction,
+// then multiply-accumulate by 85 on 4 (SSE4.1) or 8 (AVX2) groups at once.
+template <typename Alphabet = alphabet::Adobe>
+size_t decodeSSE41(const char* input, size_t length, uint8_t*& output, DecodeState& state);
+template <typename Alphabet = alphabet::Adobe>
+size_t decodeAVX2(const char* input, size_t length, uint8_t*& output, DecodeState& state);
+
+// Trusted counterparts of the decoders above, for text known to come from
+// the encoder: nothing is validated, so they never throw, and malformed
+// input yields unspecified bytes (still at most 4 per input char). Digit
+// runs are decoded in place, without staging. They stop at the '~' of an
+// end marker only.
+template <typename Alphabet = alphabet::Adobe>
+size_t decodeTrustedScalar(const char* input, size_t length, uint8_t*& output,
+                           DecodeState& state);
+template <typename Alphabet = alphabet::Adobe>
+size_t decodeTrustedSSE41(const char* input, size_t length, uint8_t*& output,
+                          DecodeState& state);
+template <typename Alphabet = alphabet::Adobe>
+size_t decodeTrustedAVX2(const char* input, size_t length, uint8_t*& output,
+                         DecodeState& state);
+
+// CPU feature queries
+bool hasSSE41();
+bool hasAVX2();
+
+// Best encoder kernel for this CPU, selected once by CPUID
+template <typename Alphabet = alphabet::Adobe>
+EncodeKernel encodeKernel();
+
+// Best decoder kernel for this CPU, selected once by CPUID
+template <typename Alphabet = alphabet::Adobe>
+DecodeKernel decodeKernel();
+
+// Best trusted decoder kernel for this CPU
+template <typename Alphabet = alphabet::Adobe>
+DecodeKernel decodeTrustedKernel();
+
+// Decodes `input` with the selected kernel, handing whatever it stops at
+// to the scalar path. Stops at the first '~' of an end marker and returns
+// the number of chars consumed. Does not flush the trailing partial group.
+template <typename Alphabet = alphabet::Adobe>
+size_t decode(const char* input, size_t length, uint8_t*& output, DecodeState& state);
+
+// decode() without validation, see decodeTrustedScalar()
+template <typename Alphabet = alphabet::Adobe>
+size_t decodeTrusted(const char* input, size_t length, uint8_t*& output, DecodeState& state);
+
+} // namespace simd
+} // namespace ascii85
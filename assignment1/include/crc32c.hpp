@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ascii85 {
+
+// Running CRC32C (Castagnoli) digest, the checksum of iSCSI, ext4 and
+// SSE4.2's crc32 instruction, which computes it where the CPU has one
+class Crc32c {
+public:
+    // Add `length` bytes to the digest
+    void update(const void* data, size_t length);
+
+    // Add the digest of `length` further bytes that was computed on its
+    // own (e.g. by another thread), as if they had been passed to update()
+    void append(uint32_t digest, size_t length);
+
+    // Digest of everything added so far
+    uint32_t value() const { return crc; }
+
+    // Digest of a single buffer
+    static uint32_t compute(const void* data, size_t length);
+
+private:
+    uint32_t crc = 0;
+};
+
+} // namespace ascii85
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace ascii85 {
+
+// RAII wrapper around a memory-mapped file
+class MappedFile {
+public:
+    // Map an existing file read-only
+    static MappedFile openRead(const std::string& path);
+
+    // Create (or truncate) a file of `size` bytes and map it writable
+    static MappedFile create(const std::string& path, size_t size);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Unmaps the file; a writable file is cut to its final size()
+    ~MappedFile();
+
+    uint8_t* data() { return mapping; }
+    const uint8_t* data() const { return mapping; }
+    size_t size() const { return length; }
+
+    // Set the size a writable file is truncated to when it is closed
+    void setFinalSize(size_t size) { finalSize = size; }
+
+    // Drop the pages covering [offset, offset + size) from this process. The
+    // data stays in the page cache (dirty pages are still written back), this
+    // only keeps a sequential pass from growing the resident set.
+    void release(size_t offset, size_t size);
+
+private:
+    MappedFile() = default;
+    void close();
+
+    int fd = -1;
+    uint8_t* mapping = nullptr;
+    size_t length = 0;
+    size_t finalSize = 0;
+    bool writable = false;
+};
+
+} // namespace ascii85
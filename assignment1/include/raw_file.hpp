@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdlib>
+
+namespace ascii85 {
+
+// Heap buffer aligned to the page size, so read(2) and write(2) can move
+// whole pages in and out of it
+class AlignedBuffer {
+public:
+    explicit AlignedBuffer(size_t size);
+
+    char* data() { return buffer.get(); }
+    const char* data() const { return buffer.get(); }
+    size_t size() const { return length; }
+
+private:
+    struct Free {
+        void operator()(char* pointer) const { std::free(pointer); }
+    };
+
+    std::unique_ptr<char, Free> buffer;
+    size_t length;
+};
+
+// RAII file descriptor read and written with plain read(2)/write(2), no
+// stream buffering in between
+class RawFile {
+public:
+    // Open an existing file for reading
+    static RawFile openRead(const std::string& path);
+
+    // Create (or truncate) a file for writing
+    static RawFile create(const std::string& path);
+
+    // Use a descriptor owned by someone else (e.g. STDIN_FILENO); it is not
+    // closed. `name` is used in error messages.
+    static RawFile borrow(int fd, const std::string& name);
+
+    RawFile(RawFile&& other) noexcept;
+    RawFile& operator=(RawFile&& other) noexcept;
+    RawFile(const RawFile&) = delete;
+    RawFile& operator=(const RawFile&) = delete;
+
+    ~RawFile();
+
+    int descriptor() const { return fd; }
+
+    // Whether the descriptor is a terminal
+    bool isTerminal() const;
+
+    // Read up to `size` bytes, retrying on EINTR. Returns 0 at the end of
+    // the input; pipes and terminals may return less than asked for.
+    size_t read(char* buffer, size_t size);
+
+    // Read everything up to the end of the input
+    std::string readAll();
+
+    // Write all `size` bytes, retrying on EINTR and short writes
+    void write(const char* data, size_t size);
+
+private:
+    RawFile() = default;
+    void close();
+
+    int fd = -1;
+    bool owned = false;
+    std::string name;
+};
+
+} // namespace ascii85
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ascii85 {
+
+// Lock-free bounded queue between exactly one producer thread and one
+// consumer thread. Each side owns one index and only reads the other's, so
+// a push or pop is a plain store plus one release.
+template <typename T>
+class SpscRing {
+public:
+    // Room for at least `capacity` elements
+    explicit SpscRing(size_t capacity) : slots(roundUp(capacity)), mask(slots.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side; false if the ring is full
+    bool tryPush(T value) {
+        size_t back = tail.load(std::memory_order_relaxed);
+        if (back - head.load(std::memory_order_acquire) == slots.size()) {
+            return false;
+        }
+        slots[back & mask] = std::move(value);
+        tail.store(back + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false if the ring is empty
+    bool tryPop(T& value) {
+        size_t front = head.load(std::memory_order_relaxed);
+        if (front == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(slots[front & mask]);
+        head.store(front + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static size_t roundUp(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<T> slots;
+    size_t mask;
+
+    // On separate cache lines, so the two sides do not bounce one line
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+} // namespace ascii85
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace ascii85 {
+
+// Monotonic clock reading in nanoseconds, for the time counters
+inline uint64_t nowNanos() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+// Measures consecutive intervals: every lap() returns the time since the
+// previous one (or since construction)
+class Stopwatch {
+public:
+    Stopwatch() : last(nowNanos()) {}
+
+    uint64_t lap() {
+        uint64_t now = nowNanos();
+        uint64_t elapsed = now - last;
+        last = now;
+        return elapsed;
+    }
+
+private:
+    uint64_t last;
+};
+
+// Counters filled in by the process functions. Threads keep their own
+// tallies and add them here once per input (or block), with relaxed
+// atomics, so the counters cost next to nothing while the codec runs.
+class Stats {
+public:
+    // Bytes read and written by the codec (binary and text side alike)
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> bytesOut{0};
+
+    // 4-byte groups encoded or decoded, a trailing partial group included,
+    // and how many of them were a single shortcut char ('z', 'y')
+    std::atomic<uint64_t> groups{0};
+    std::atomic<uint64_t> shortcutGroups{0};
+
+    // Decoding: chars skipped between the groups (whitespace and the
+    // delimiters); encoding: line breaks written
+    std::atomic<uint64_t> whitespace{0};
+
+    // Time spent in the codec and in reading and writing, summed over all
+    // threads (so with several threads it can exceed the wall time)
+    std::atomic<uint64_t> codecNanos{0};
+    std::atomic<uint64_t> ioNanos{0};
+
+    // Most buffer memory held at once (memory mappings are not buffers)
+    std::atomic<uint64_t> peakBuffer{0};
+
+    // Account for `bytes` bytes encoded into `chars` chars holding
+    // `lineBreaks` line breaks. Groups and shortcuts follow from the sizes;
+    // `frame` says whether the chars include the delimiters.
+    void addEncoded(uint64_t bytes, uint64_t chars, uint64_t lineBreaks, bool frame);
+
+    // Account for `chars` chars holding `shortcuts` shortcut chars decoded
+    // into `bytes` bytes
+    void addDecoded(uint64_t chars, uint64_t bytes, uint64_t shortcuts);
+
+    void addCodecTime(uint64_t nanos) { add(codecNanos, nanos); }
+    void addIoTime(uint64_t nanos) { add(ioNanos, nanos); }
+
+    // Note that `size` bytes of buffers are held
+    void noteBuffer(uint64_t size);
+
+    // Line breaks in `chars` chars of encoded text wrapped at `width`
+    // (0 = one line): the encoder ends every full line but the last with
+    // one, so the count follows from the size alone
+    static uint64_t lineBreaks(uint64_t chars, size_t width) {
+        return width == 0 || chars == 0 ? 0 : (chars - 1) / (width + 1);
+    }
+
+    // Multi-line report for people
+    std::string format() const;
+
+    // The counters as one JSON object
+    std::string toJson() const;
+
+private:
+    static void add(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+};
+
+} // namespace ascii85
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ascii85 {
+
+// Fixed-size pool of worker threads
+class ThreadPool {
+public:
+    // Start `threads` workers (0 = one per hardware thread)
+    explicit ThreadPool(size_t threads = 0);
+
+    // Finish queued jobs and join the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Queue a job; it runs on some worker
+    void submit(std::function<void()> job);
+
+    // Run task(0) ... task(count - 1) on the workers and wait for all of
+    // them. If tasks throw, the exception of the lowest index is rethrown.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+    // Number of threads used when 0 is requested
+    static size_t defaultThreadCount();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    bool stopping = false;
+};
+
+} // namespace ascii85
@@ -1,328 +1,735 @@
 #include "ascii85.hpp"
+#include "ascii85_simd.hpp"
+#include "mapped_file.hpp"
+#include "raw_file.hpp"
+#include "thread_pool.hpp"
 #include <stdexcept>
 #include <sstream>
 #include <iomanip>
 #include <array>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <cstring>
 #include <unistd.h> // For isatty() function
 
 namespace ascii85 {
 
-// Adobe ASCII85 uses characters starting with '!' (33) and ending with 'u' (117)
-const char* ASCII85::ENCODING_TABLE = "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstu";
-const uint32_t ASCII85::powers[5] = {85*85*85*85, 85*85*85, 85*85, 85, 1};
+template <typename Alphabet>
+std::string Base85<Alphabet>::encode(const std::string& input) {
+    if (input.empty()) {
+        return "";
+    }
+    
+    std::string output(encodedSizeBound(input.length()), '\0');
+    size_t written = encode(reinterpret_cast<const uint8_t*>(input.data()), input.length(), &output[0]);
+    output.resize(written);
+    
+    return output;
+}
 
-// Initialize decoding table
-uint8_t ASCII85::DECODING_TABLE[256] = {0};
-struct DecodingTableInitializer {
-    DecodingTableInitializer() {
-        // Initialize all values to invalid (255)
-        std::fill_n(ASCII85::DECODING_TABLE, 256, 255);
-        
-        // Set valid character mappings
-        for (int i = 0; i < 85; i++) {
-            ASCII85::DECODING_TABLE[static_cast<uint8_t>(ASCII85::ENCODING_TABLE[i])] = i;
-        }
+template <typename Alphabet>
+size_t Base85<Alphabet>::encode(const uint8_t* input, size_t length, char* output) {
+    if (!Alphabet::PARTIAL_GROUPS && length % 4 != 0) {
+        throw std::invalid_argument("Input length must be a multiple of 4");
     }
-} decodingTableInitializer;
+    char* out = output;
+    
+    // Bulk of the input goes through the fastest kernel this CPU supports,
+    // the remainder (including a partial group) through the scalar path
+    size_t consumed = simd::encodeKernel<Alphabet>()(input, length, out);
+    simd::encodeScalar<Alphabet>(input + consumed, length - consumed, out);
+    
+    return out - output;
+}
 
-std::string ASCII85::encode(const std::string& input) {
+template <typename Alphabet>
+std::string Base85<Alphabet>::encode(const std::string& input, const EncodeOptions& options) {
+    std::string output(encodedSizeBound(input.length(), options), '\0');
+    size_t written = encode(reinterpret_cast<const uint8_t*>(input.data()), input.length(),
+                            &output[0], options);
+    output.resize(written);
+    
+    return output;
+}
+
+template <typename Alphabet>
+size_t Base85<Alphabet>::encode(const uint8_t* input, size_t length, char* output,
+                                const EncodeOptions& options) {
+    if (!options.frame && options.lineWidth == 0) {
+        return encode(input, length, output);
+    }
+    
+    Encoder encoder(options);
+    size_t written = encoder.update(input, length, output);
+    return written + encoder.finish(output + written);
+}
+
+template <typename Alphabet>
+std::string Base85<Alphabet>::decode(const std::string& input, bool trusted) {
     if (input.empty()) {
         return "";
     }
     
-    std::stringstream output;
-    const unsigned char* data = reinterpret_cast<const unsigned char*>(input.data());
-    size_t length = input.length();
+    // Decode slice by slice through a scratch buffer so the output never
+    // has to be sized for the worst case of the whole input
+    const size_t SLICE_SIZE = 65536;
+    std::vector<uint8_t> scratch(decodedSizeBound(SLICE_SIZE));
+    std::string output;
+    output.reserve(input.length() / 5 * 4 + 4);
     
-    // Adobe ASCII85 encoding: Process input in chunks of 4 bytes
-    for (size_t i = 0; i < length; i += 4) {
-        // Determine how many bytes we have in this chunk (1-4)
-        size_t bytesInChunk = std::min(length - i, size_t(4));
-        
-        // Calculate the 32-bit value for these bytes (big-endian)
-        uint32_t value = 0;
-        for (size_t j = 0; j < bytesInChunk; j++) {
-            value |= static_cast<uint32_t>(data[i + j]) << (8 * (3 - j));
-        }
-        
-        // Special case: all zeros
-        if (value == 0 && bytesInChunk == 4) {
-            output << 'z';
-            continue;
-        }
-        
-        // Convert value to base-85 (5 ASCII85 characters)
-        char encoded[5];
-        for (int j = 0; j < 5; j++) {
-            encoded[j] = '!' + (value / powers[j] % 85);
-        }
-        
-        // Output only as many characters as needed (n+1 for n input bytes)
-        output.write(encoded, bytesInChunk + 1);
+    Decoder decoder(trusted);
+    for (size_t i = 0; i < input.length(); i += SLICE_SIZE) {
+        size_t sliceLength = std::min(input.length() - i, SLICE_SIZE);
+        size_t written = decoder.feed(input.data() + i, sliceLength, scratch.data());
+        output.append(reinterpret_cast<const char*>(scratch.data()), written);
     }
     
-    return output.str();
+    size_t written = decoder.finish(scratch.data());
+    output.append(reinterpret_cast<const char*>(scratch.data()), written);
+    
+    return output;
 }
 
-std::string ASCII85::decode(const std::string& input) {
-    if (input.empty()) {
-        return "";
+template <typename Alphabet>
+size_t Base85<Alphabet>::decode(const char* input, size_t length, uint8_t* output,
+                                bool trusted) {
+    Decoder decoder(trusted);
+    size_t written = decoder.feed(input, length, output);
+    return written + decoder.finish(output + written);
+}
+
+template <typename Alphabet>
+Base85<Alphabet>::Encoder::Encoder(const EncodeOptions& options, size_t column)
+    : options(options), column(column), opened(column > 0) {
+    if (options.frame && !Alphabet::FRAMES) {
+        throw std::invalid_argument(std::string("Framing is not defined for ") + Alphabet::NAME);
     }
+    this->options.lineWidth = options.effectiveLineWidth();
+}
+
+template <typename Alphabet>
+size_t Base85<Alphabet>::Encoder::update(const uint8_t* input, size_t length, char* output) {
+    char* out = output;
     
-    // Check for non-ASCII characters
-    for (size_t i = 0; i < input.length(); ++i) {
-        unsigned char c = static_cast<unsigned char>(input[i]);
-        if (c > 127) {
-            throw std::runtime_error("Invalid ASCII85 input: character out of range");
+    if (options.frame && !opened) {
+        put("<~", 2, out);
+    }
+    opened = true;
+    
+    // Complete the group left over from the previous call first
+    if (pendingCount > 0) {
+        size_t take = std::min(length, 4 - pendingCount);
+        std::memcpy(pending + pendingCount, input, take);
+        sum(input, take);
+        pendingCount += take;
+        input += take;
+        length -= take;
+        
+        if (pendingCount < 4) {
+            return out - output;
         }
+        encodeGroups(pending, 4, out);
+        pendingCount = 0;
     }
     
-    // Verify the entire input is valid - check for incomplete groups
-    // Count the number of valid characters (excluding whitespace and 'z')
-    size_t validCharCount = 0;
-    bool hasZ = false;
+    // Encode whole groups and keep the remainder for the next call. With a
+    // checksum every slice is summed right after it is encoded.
+    size_t whole = length - length % 4;
+    size_t slice = checksum != nullptr ? CHECKSUM_SLICE : std::max<size_t>(whole, 1);
+    for (size_t i = 0; i < whole; i += slice) {
+        size_t count = std::min(whole - i, slice);
+        encodeGroups(input + i, count, out);
+        sum(input + i, count);
+    }
+    pendingCount = length - whole;
+    std::memcpy(pending, input + whole, pendingCount);
+    sum(input + whole, pendingCount);
     
-    for (size_t i = 0; i < input.length(); ++i) {
-        char c = input[i];
-        if (c > ' ' && c != 'z') {
-            validCharCount++;
-        } else if (c == 'z') {
-            hasZ = true;
-        }
+    return out - output;
+}
+
+template <typename Alphabet>
+size_t Base85<Alphabet>::Encoder::finish(char* output) {
+    char* out = output;
+    
+    if (options.frame && !opened) {
+        put("<~", 2, out);
     }
     
-    // If there are still non-whitespace characters after removing all valid 
-    // complete groups (multiples of 5) and 'z' characters, validate that
-    // the remaining count makes sense for a final partial group (must be 2-4 chars)
-    if (validCharCount % 5 != 0) {
-        size_t remainder = validCharCount % 5;
-        // Valid incomplete groups must be 2-4 characters
-        if (remainder == 1) {
-            throw std::runtime_error("Invalid ASCII85 input: incomplete group");
-        }
+    if (!Alphabet::PARTIAL_GROUPS && pendingCount != 0) {
+        pendingCount = 0;
+        throw std::invalid_argument("Input length must be a multiple of 4");
     }
+    char group[5];
+    char* groupEnd = group;
+    simd::encodeScalar<Alphabet>(pending, pendingCount, groupEnd);
+    put(group, groupEnd - group, out);
     
-    std::stringstream output;
-    const char* data = input.data();
-    size_t length = input.length();
+    if (options.frame) {
+        // The end marker moves to a new line rather than being split
+        if (options.lineWidth != 0 && column + 2 > options.lineWidth) {
+            *out++ = '\n';
+            column = 0;
+        }
+        put("~>", 2, out);
+    }
     
-    // Process input in chunks
-    size_t i = 0;
-    while (i < length) {
-        // Handle special 'z' case (four zero bytes)
-        if (data[i] == 'z') {
-            // Check if 'z' is used incorrectly (within a group)
-            if (i > 0 && i < length - 1) {
-                // Check if the previous or next character is part of a group (not whitespace)
-                bool prev_is_group = (i > 0 && data[i-1] > ' ' && data[i-1] != 'z');
-                bool next_is_group = (i < length - 1 && data[i+1] > ' ' && data[i+1] != 'z');
-                if (prev_is_group || next_is_group) {
-                    throw std::runtime_error("Invalid ASCII85 input: 'z' character in wrong context");
-                }
-            }
-            
-            output.write("\0\0\0\0", 4);
-            i++;
-            continue;
+    pendingCount = 0;
+    column = 0;
+    opened = false;
+    return out - output;
+}
+
+template <typename Alphabet>
+void Base85<Alphabet>::Encoder::put(const char* chars, size_t count, char*& out) {
+    for (size_t i = 0; i < count; i++) {
+        if (options.lineWidth != 0 && column == options.lineWidth) {
+            *out++ = '\n';
+            column = 0;
         }
-        
-        // Read up to 5 characters to form a group
-        uint32_t value = 0;
-        int charCount = 0;
-        size_t groupStart = i;
-        
-        for (int j = 0; j < 5 && i < length; j++, i++) {
-            char c = data[i];
-            
-            // Skip whitespace
-            if (c <= ' ') {
-                j--; // Don't count whitespace
-                continue;
-            }
-            
-            // Ensure character is in valid range
-            if (c < '!' || c > 'u') {
-                throw std::runtime_error("Invalid ASCII85 input: character out of range");
-            }
-            
-            // Convert from ASCII85 to value
-            value = value * 85 + (c - '!');
-            charCount++;
-            
-            // Check for overflow during calculation
-            if (value > 0xFFFFFFFF && j < 4) {
-                throw std::runtime_error("Invalid ASCII85 input: value overflow");
-            }
+        *out++ = chars[i];
+        column++;
+    }
+}
+
+template <typename Alphabet>
+void Base85<Alphabet>::Encoder::encodeGroups(const uint8_t* input, size_t length, char*& out) {
+    if (options.lineWidth == 0) {
+        out += encode(input, length, out);
+        return;
+    }
+    
+    while (length > 0) {
+        if (column == options.lineWidth) {
+            *out++ = '\n';
+            column = 0;
         }
         
-        // Need at least 1 character to decode
-        if (charCount == 0) {
-            continue;
+        // Groups that surely fit the rest of the line go straight through
+        // the fast path; 'z' groups may leave room for another round
+        size_t room = options.lineWidth - column;
+        size_t bytes = std::min(length, room / 5 * 4);
+        if (bytes > 0) {
+            size_t written = encode(input, bytes, out);
+            out += written;
+            column += written;
+        } else {
+            // The next group may run past the end of the line
+            bytes = 4;
+            char group[5];
+            char* groupEnd = group;
+            simd::encodeScalar<Alphabet>(input, 4, groupEnd);
+            put(group, groupEnd - group, out);
         }
-        
-        // Handle incomplete groups (1-4 chars) with validation
-        if (charCount < 5) {
-            // A single character group is always invalid
-            if (charCount == 1) {
-                throw std::runtime_error("Invalid ASCII85 input: incomplete group");
-            }
-            
-            // If we reached the end of input, this is expected
-            if (groupStart + charCount >= length) {
-                // Valid end of stream with partial group
-                // Pad with 'u' characters if needed
-                for (int j = charCount; j < 5; j++) {
-                    value = value * 85 + 84; // 'u' - '!' = 84
-                    // Check for overflow after padding
-                    if (value > 0xFFFFFFFF) {
-                        throw std::runtime_error("Invalid ASCII85 input: value overflow");
-                    }
+        input += bytes;
+        length -= bytes;
+    }
+}
+
+template <typename Alphabet>
+size_t Base85<Alphabet>::Decoder::feed(const char* input, size_t length, uint8_t* output) {
+    uint8_t* out = output;
+    size_t i = 0;
+    
+    while (i < length) {
+        unsigned char c = static_cast<unsigned char>(input[i]);
+        switch (frame) {
+            case Frame::START:
+                // Leading whitespace, then an optional "<~"
+                if (DECODING_TABLE[c] == (NOT_DIGIT | WHITESPACE)) {
+                    i++;
+                } else if (c == '<') {
+                    frame = Frame::OPENING;
+                    i++;
+                } else {
+                    frame = Frame::BODY;
                 }
-            } else {
-                // If we didn't reach the end of input but have an incomplete group,
-                // this is invalid unless it's due to whitespace
-                bool hasOnlyWhitespace = true;
-                for (size_t j = groupStart + charCount; j < length; j++) {
-                    if (data[j] > ' ') {
-                        hasOnlyWhitespace = false;
-                        break;
-                    }
+                break;
+            case Frame::OPENING:
+                // A '<' that does not start "<~" is an ordinary digit
+                if (c == '~') {
+                    i++;
+                } else {
+                    decodeBody("<", 1, out);
                 }
-                
-                if (!hasOnlyWhitespace) {
-                    throw std::runtime_error("Invalid ASCII85 input: incomplete group");
+                frame = Frame::BODY;
+                break;
+            case Frame::BODY:
+                // The decoder stops only at the '~' of an end marker
+                i += decodeBody(input + i, length - i, out);
+                if (i < length) {
+                    frame = Frame::CLOSING;
+                    i++;
                 }
-                
-                // Pad with 'u' characters if needed
-                for (int j = charCount; j < 5; j++) {
-                    value = value * 85 + 84; // 'u' - '!' = 84
-                    // Check for overflow after padding
-                    if (value > 0xFFFFFFFF) {
-                        throw std::runtime_error("Invalid ASCII85 input: value overflow");
-                    }
+                break;
+            case Frame::CLOSING:
+                if (c != '>') {
+                    throw std::runtime_error("Invalid ASCII85 input: character out of range");
                 }
-            }
-        }
-        
-        // Final check for overflow - max 32-bit value is 0xFFFFFFFF
-        if (value > 0xFFFFFFFF) {
-            throw std::runtime_error("Invalid ASCII85 input: value overflow");
-        }
-        
-        // Determine how many bytes to output based on input char count
-        int bytesToOutput = charCount == 5 ? 4 : charCount - 1;
-        
-        // Convert to bytes and output
-        for (int j = 0; j < bytesToOutput; j++) {
-            unsigned char byte = (value >> (8 * (3 - j))) & 0xFF;
-            output.put(byte);
+                frame = Frame::CLOSED;
+                i++;
+                break;
+            case Frame::CLOSED:
+                if (DECODING_TABLE[c] != (NOT_DIGIT | WHITESPACE)) {
+                    throw std::runtime_error("Invalid ASCII85 input: data after end marker");
+                }
+                i++;
+                break;
         }
     }
     
-    return output.str();
+    return out - output;
+}
+
+template <typename Alphabet>
+size_t Base85<Alphabet>::Decoder::finish(uint8_t* output) {
+    uint8_t* out = output;
+    
+    if (frame == Frame::OPENING) {
+        decodeBody("<", 1, out);
+    } else if (frame == Frame::CLOSING) {
+        throw std::runtime_error("Invalid ASCII85 input: character out of range");
+    }
+    
+    uint8_t* tail = out;
+    simd::decodeFinish<Alphabet>(state, out);
+    if (checksum != nullptr) {
+        checksum->update(tail, out - tail);
+    }
+    uint64_t shortcuts = state.shortcuts;
+    state = simd::DecodeState();
+    state.shortcuts = shortcuts;
+    frame = INITIAL_FRAME;
+    return out - output;
 }
 
-void ASCII85::processStream(std::istream& input, std::ostream& output, bool decode) {
+template <typename Alphabet>
+size_t Base85<Alphabet>::Decoder::decodeBody(const char* input, size_t length, uint8_t*& out) {
+    auto decodeSlice = trusted ? simd::decodeTrusted<Alphabet> : simd::decode<Alphabet>;
+    if (checksum == nullptr) {
+        return decodeSlice(input, length, out, state);
+    }
+    
+    size_t i = 0;
+    while (i < length) {
+        size_t count = std::min(length - i, CHECKSUM_SLICE);
+        uint8_t* start = out;
+        size_t consumed = decodeSlice(input + i, count, out, state);
+        checksum->update(start, out - start);
+        i += consumed;
+        if (consumed < count) {
+            break;
+        }
+    }
+    return i;
+}
+
+namespace {
+
+// Buffers of the stream mode, reusable from one input to the next (the
+// size bounds are the same for every variant)
+struct StreamBuffers {
+    StreamBuffers(size_t blockSize, const EncodeOptions& options)
+        : input(blockSize),
+          output(std::max(ASCII85::decodedSizeBound(blockSize),
+                          ASCII85::encodedSizeBound(blockSize + 3, options))) {}
+    
+    AlignedBuffer input;
+    AlignedBuffer output;
+};
+
+// Adds one coded input of `in` bytes or chars that became `out` to
+// `stats`. Decoding passes the shortcuts its decoder counted; encoded text
+// needs no count, its line breaks follow from its size.
+void addCoded(Stats& stats, bool decode, uint64_t in, uint64_t out, uint64_t shortcuts,
+              const EncodeOptions& options) {
     if (decode) {
-        // Decoding implementation - process data character by character
-        char c;
-        std::string group;
-        
-        while (input.get(c)) {
-            // Handle 'z' special case immediately
-            if (c == 'z') {
-                output.write("\0\0\0\0", 4);
-                continue;
+        stats.addDecoded(in, out, shortcuts);
+    } else {
+        stats.addEncoded(in, out, Stats::lineBreaks(out, options.effectiveLineWidth()),
+                         options.frame);
+    }
+}
+
+// Stream mode over any source and sink: read(buffer, size) returns the
+// number of bytes read (0 at the end of the input) and write(data, size)
+// takes all of them
+template <typename Alphabet, typename Read, typename Write>
+void streamCodec(Read&& read, Write&& write, bool decode, StreamBuffers& buffers,
+                 const EncodeOptions& options, Crc32c* checksum, Stats* stats) {
+    char* in = buffers.input.data();
+    char* out = buffers.output.data();
+    size_t blockSize = buffers.input.size();
+    
+    // Large blocks go to an incremental decoder, or to one encoder that
+    // carries partial groups across blocks
+    typename Base85<Alphabet>::Decoder decoder(options.trusted);
+    typename Base85<Alphabet>::Encoder encoder(decode ? EncodeOptions() : options);
+    decoder.setChecksum(checksum);
+    encoder.setChecksum(checksum);
+    auto update = [&](size_t count) {
+        return decode ? decoder.feed(in, count, reinterpret_cast<uint8_t*>(out))
+                      : encoder.update(reinterpret_cast<const uint8_t*>(in), count, out);
+    };
+    auto finish = [&] {
+        return decode ? decoder.finish(reinterpret_cast<uint8_t*>(out)) : encoder.finish(out);
+    };
+    
+    // Tallies of this input, added to `stats` at the end
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t codecTime = 0;
+    uint64_t ioTime = 0;
+    Stopwatch watch;
+    
+    size_t count;
+    do {
+        count = read(in, blockSize);
+        ioTime += watch.lap();
+        size_t written = count != 0 ? update(count) : finish();
+        codecTime += watch.lap();
+        write(out, written);
+        ioTime += watch.lap();
+        bytesRead += count;
+        bytesWritten += written;
+    } while (count != 0);
+    
+    if (stats != nullptr) {
+        addCoded(*stats, decode, bytesRead, bytesWritten, decoder.shortcuts(), options);
+        stats->addCodecTime(codecTime);
+        stats->addIoTime(ioTime);
+    }
+}
+
+// Encodes a line typed at a terminal into the answer for it: the encoded
+// text and a newline. Waiting for the terminal is not counted as I/O time.
+template <typename Alphabet>
+std::string encodeLine(const std::string& line, const EncodeOptions& options, Crc32c* checksum,
+                       Stats* stats) {
+    Stopwatch watch;
+    if (checksum != nullptr) {
+        checksum->update(line.data(), line.size());
+    }
+    std::string encoded = Base85<Alphabet>::encode(line, options);
+    if (stats != nullptr) {
+        uint64_t lineBreaks = Stats::lineBreaks(encoded.size(), options.effectiveLineWidth());
+        stats->addEncoded(line.size(), encoded.size() + 1, lineBreaks + 1, options.frame);
+        stats->addCodecTime(watch.lap());
+    }
+    return encoded + '\n';
+}
+
+// Batch mode output name: `<file>.a85` when encoding, the name without
+// `.a85` when decoding
+std::string batchOutputPath(const std::string& path, bool decode) {
+    const std::string suffix = ".a85";
+    if (!decode) {
+        return path + suffix;
+    }
+    if (path.size() <= suffix.size() ||
+        path.compare(path.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        throw std::runtime_error("Input name does not end in " + suffix);
+    }
+    return path.substr(0, path.size() - suffix.size());
+}
+
+// Encodes or decodes one file of a batch through the worker's buffers.
+// A failed file leaves no output behind.
+template <typename Alphabet>
+void processBatchFile(const std::string& path, bool decode, StreamBuffers& buffers,
+                      const EncodeOptions& options, Stats* stats) {
+    std::string outputPath = batchOutputPath(path, decode);
+    RawFile input = RawFile::openRead(path);
+    RawFile output = RawFile::create(outputPath);
+    try {
+        auto read = [&input](char* buffer, size_t size) { return input.read(buffer, size); };
+        auto write = [&output](const char* data, size_t size) { output.write(data, size); };
+        streamCodec<Alphabet>(read, write, decode, buffers, options, nullptr, stats);
+    } catch (...) {
+        std::remove(outputPath.c_str());
+        throw;
+    }
+}
+
+} // namespace
+
+template <typename Alphabet>
+void Base85<Alphabet>::processStream(std::istream& input, std::ostream& output, bool decode,
+                                     size_t blockSize, const EncodeOptions& options,
+                                     Crc32c* checksum, Stats* stats) {
+    if (blockSize == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    
+    // Interactive encoding works line by line
+    bool isInteractive = !decode && &input == &std::cin && isatty(fileno(stdin));
+    
+    if (isInteractive) {
+        std::string line;
+        while (std::getline(input, line)) {
+            if (!line.empty()) {
+                // Encode and output immediately, with a newline for better usability
+                output << encodeLine<Alphabet>(line, options, checksum, stats);
+                output.flush();
             }
-            
-            // Skip whitespace
-            if (c <= ' ') {
-                // If we have a complete group, process it
-                if (group.length() > 0) {
-                    std::string decoded = ASCII85::decode(group);
-                    output.write(decoded.data(), decoded.length());
-                    group.clear();
+        }
+        return;
+    }
+    
+    auto read = [&input](char* buffer, size_t size) {
+        input.read(buffer, size);
+        return static_cast<size_t>(input.gcount());
+    };
+    auto write = [&output](const char* data, size_t size) {
+        output.write(data, size);
+    };
+    StreamBuffers buffers(blockSize, options);
+    if (stats != nullptr) {
+        stats->noteBuffer(buffers.input.size() + buffers.output.size());
+    }
+    streamCodec<Alphabet>(read, write, decode, buffers, options, checksum, stats);
+}
+
+template <typename Alphabet>
+void Base85<Alphabet>::processStream(int inputFd, int outputFd, bool decode, size_t blockSize,
+                                     const EncodeOptions& options, Crc32c* checksum,
+                                     Stats* stats) {
+    if (blockSize == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    
+    RawFile input = RawFile::borrow(inputFd, "input");
+    RawFile output = RawFile::borrow(outputFd, "output");
+    
+    if (!decode && input.isTerminal()) {
+        // A terminal hands over a line per read(); every line is encoded
+        // on its own and answered right away
+        std::vector<char> buffer(blockSize);
+        std::string pending;
+        while (size_t count = input.read(buffer.data(), buffer.size())) {
+            pending.append(buffer.data(), count);
+            size_t start = 0;
+            size_t newline;
+            while ((newline = pending.find('\n', start)) != std::string::npos) {
+                if (newline > start) {
+                    std::string line = pending.substr(start, newline - start);
+                    std::string encoded = encodeLine<Alphabet>(line, options, checksum, stats);
+                    output.write(encoded.data(), encoded.size());
                 }
-                continue;
-            }
-            
-            // Validate character
-            if (c < '!' || c > 'u') {
-                throw std::runtime_error("Invalid ASCII85 input: character out of range");
-            }
-            
-            // Add character to group
-            group += c;
-            
-            // Process complete group (5 characters)
-            if (group.length() == 5) {
-                std::string decoded = ASCII85::decode(group);
-                output.write(decoded.data(), decoded.length());
-                group.clear();
+                start = newline + 1;
             }
+            pending.erase(0, start);
         }
-        
-        // Process any remaining characters
-        if (!group.empty()) {
-            std::string decoded = ASCII85::decode(group);
-            output.write(decoded.data(), decoded.length());
+        if (!pending.empty()) {
+            std::string encoded = encodeLine<Alphabet>(pending, options, checksum, stats);
+            output.write(encoded.data(), encoded.size());
+        }
+        return;
+    }
+    
+    auto read = [&input](char* buffer, size_t size) { return input.read(buffer, size); };
+    auto write = [&output](const char* data, size_t size) { output.write(data, size); };
+    StreamBuffers buffers(blockSize, options);
+    if (stats != nullptr) {
+        stats->noteBuffer(buffers.input.size() + buffers.output.size());
+    }
+    streamCodec<Alphabet>(read, write, decode, buffers, options, checksum, stats);
+}
+
+namespace {
+
+// Buffer mode over any sink, write(data, size) taking all of the result
+template <typename Alphabet, typename Write>
+void bufferCodec(const std::string& data, Write&& write, bool decode, size_t threads,
+                 const EncodeOptions& options, Crc32c* checksum, Stats* stats) {
+    using Codec = Base85<Alphabet>;
+    Stopwatch watch;
+    uint64_t shortcuts = 0;
+    std::string result = decode ? Codec::decodeParallel(data, threads, checksum, options.trusted,
+                                                        stats != nullptr ? &shortcuts : nullptr)
+                                : Codec::encodeParallel(data, threads, options, checksum);
+    if (stats != nullptr) {
+        addCoded(*stats, decode, data.size(), result.size(), shortcuts, options);
+        stats->addCodecTime(watch.lap());
+        stats->noteBuffer(data.size() + result.size());
+    }
+    write(result.data(), result.size());
+    if (stats != nullptr) {
+        stats->addIoTime(watch.lap());
+    }
+}
+
+} // namespace
+
+template <typename Alphabet>
+void Base85<Alphabet>::processBuffer(const std::string& data, std::ostream& output, bool decode,
+                                     size_t threads, const EncodeOptions& options,
+                                     Crc32c* checksum, Stats* stats) {
+    auto write = [&output](const char* data, size_t size) { output.write(data, size); };
+    bufferCodec<Alphabet>(data, write, decode, threads, options, checksum, stats);
+}
+
+template <typename Alphabet>
+void Base85<Alphabet>::processBuffer(const std::string& data, int outputFd, bool decode,
+                                     size_t threads, const EncodeOptions& options,
+                                     Crc32c* checksum, Stats* stats) {
+    RawFile output = RawFile::borrow(outputFd, "output");
+    auto write = [&output](const char* data, size_t size) { output.write(data, size); };
+    bufferCodec<Alphabet>(data, write, decode, threads, options, checksum, stats);
+}
+
+template <typename Alphabet>
+void Base85<Alphabet>::processFile(const std::string& inputPath, const std::string& outputPath,
+                                   bool decode, size_t threads, const EncodeOptions& options,
+                                   Crc32c* checksum, Stats* stats) {
+    Stopwatch watch;
+    MappedFile input = MappedFile::openRead(inputPath);
+    size_t bound = decode ? decodedSizeBound(input.size()) : encodedSizeBound(input.size(), options);
+    MappedFile output = MappedFile::create(outputPath, bound);
+    uint64_t ioTime = watch.lap();
+    
+    // Walk the mappings in windows and drop every finished window, so the
+    // resident set stays small however large the files are
+    const size_t WINDOW_SIZE = size_t(64) << 20;
+    const char* in = reinterpret_cast<const char*>(input.data());
+    size_t written = 0;
+    uint64_t shortcuts = 0;
+    
+    if (decode && threads != 1) {
+        // Groups straddle arbitrary window boundaries, so the parallel
+        // decoder plans over the whole mapping at once
+        written = decodeParallel(in, input.size(), output.data(), threads, checksum,
+                                 options.trusted, &shortcuts);
+    } else if (decode) {
+        Decoder decoder(options.trusted);
+        decoder.setChecksum(checksum);
+        for (size_t i = 0; i < input.size(); i += WINDOW_SIZE) {
+            size_t length = std::min(input.size() - i, WINDOW_SIZE);
+            size_t start = written;
+            written += decoder.feed(in + i, length, output.data() + written);
+            input.release(i, length);
+            output.release(start, written - start);
+        }
+        written += decoder.finish(output.data() + written);
+        shortcuts = decoder.shortcuts();
+    } else if (threads != 1 && (options.frame || options.lineWidth != 0)) {
+        // Line breaks depend on everything before them, so the parallel
+        // encoder plans over the whole mapping at once
+        char* out = reinterpret_cast<char*>(output.data());
+        written = encodeParallel(input.data(), input.size(), out, threads, options, checksum);
+    } else if (threads != 1) {
+        // Windows are a multiple of 4 bytes, so each one is encoded on its own
+        char* out = reinterpret_cast<char*>(output.data());
+        for (size_t i = 0; i < input.size(); i += WINDOW_SIZE) {
+            size_t length = std::min(input.size() - i, WINDOW_SIZE);
+            size_t start = written;
+            written += encodeParallel(input.data() + i, length, out + written, threads,
+                                      EncodeOptions(), checksum);
+            input.release(i, length);
+            output.release(start, written - start);
         }
     } else {
-        // Encoding implementation - handle both interactive (line-based) and piped input
-        const size_t BUFFER_SIZE = 4096;
-        
-        // First check if stdin is a terminal (interactive) or a pipe
-        bool isInteractive = isatty(fileno(stdin));
-        
-        if (isInteractive) {
-            // Interactive mode - process line by line
-            std::string line;
-            while (std::getline(input, line)) {
-                if (!line.empty()) {
-                    // Encode and output immediately
-                    std::string encoded = ASCII85::encode(line);
-                    output << encoded << std::endl; // Add newline for better usability
-                    output.flush(); // Make sure output is displayed immediately
-                }
-            }
-        } else {
-            // Pipe mode - process in chunks for efficiency
-            std::vector<char> buffer(BUFFER_SIZE);
-            
-            while (input) {
-                input.read(buffer.data(), BUFFER_SIZE);
-                std::streamsize bytesRead = input.gcount();
-                
-                if (bytesRead > 0) {
-                    std::string data(buffer.data(), bytesRead);
-                    std::string encoded = ASCII85::encode(data);
-                    output << encoded;
-                }
-            }
+        char* out = reinterpret_cast<char*>(output.data());
+        Encoder encoder(options);
+        encoder.setChecksum(checksum);
+        for (size_t i = 0; i < input.size(); i += WINDOW_SIZE) {
+            size_t length = std::min(input.size() - i, WINDOW_SIZE);
+            size_t start = written;
+            written += encoder.update(input.data() + i, length, out + written);
+            input.release(i, length);
+            output.release(start, written - start);
         }
+        written += encoder.finish(out + written);
+    }
+    
+    if (stats != nullptr) {
+        addCoded(*stats, decode, input.size(), written, shortcuts, options);
+        stats->addCodecTime(watch.lap());
+        stats->addIoTime(ioTime);
     }
+    output.setFinalSize(written);
 }
 
-void ASCII85::processBuffer(const std::string& data, std::ostream& output, bool decode) {
-    if (decode) {
-        std::string decoded = ASCII85::decode(data);
-        output.write(decoded.data(), decoded.length());
-    } else {
-        std::string encoded = ASCII85::encode(data);
-        output << encoded;
+template <typename Alphabet>
+std::vector<std::string> Base85<Alphabet>::processFiles(const std::vector<std::string>& paths,
+                                                        bool decode, size_t threads,
+                                                        size_t blockSize,
+                                                        const EncodeOptions& options,
+                                                        Stats* stats) {
+    if (blockSize == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    if (threads == 0) {
+        threads = ThreadPool::defaultThreadCount();
+    }
+    threads = std::max<size_t>(std::min(threads, paths.size()), 1);
+    
+    // Every worker pulls the next file until none are left, reusing its
+    // own buffers for all of them
+    std::vector<std::string> failures(paths.size());
+    std::atomic<size_t> next(0);
+    ThreadPool pool(threads);
+    pool.parallelFor(threads, [&](size_t) {
+        StreamBuffers buffers(blockSize, options);
+        if (stats != nullptr) {
+            stats->noteBuffer(threads * (buffers.input.size() + buffers.output.size()));
+        }
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            try {
+                processBatchFile<Alphabet>(paths[i], decode, buffers, options, stats);
+            } catch (const std::exception& e) {
+                failures[i] = paths[i] + ": " + e.what();
+            }
+        }
+    });
+    
+    std::vector<std::string> errors;
+    for (auto& failure : failures) {
+        if (!failure.empty()) {
+            errors.push_back(std::move(failure));
+        }
     }
+    return errors;
 }
 
-void ASCII85::process(std::istream& input, std::ostream& output, Mode mode, bool decode) {
+template <typename Alphabet>
+void Base85<Alphabet>::process(std::istream& input, std::ostream& output, Mode mode, bool decode,
+                               size_t blockSize, size_t threads, const EncodeOptions& options,
+                               Crc32c* checksum, Stats* stats) {
     if (mode == Mode::STREAM) {
-        processStream(input, output, decode);
+        processStream(input, output, decode, blockSize, options, checksum, stats);
     } else {
+        Stopwatch watch;
         std::stringstream buffer;
         buffer << input.rdbuf();
         std::string data = buffer.str();
-        processBuffer(data, output, decode);
+        if (stats != nullptr) {
+            stats->addIoTime(watch.lap());
+        }
+        processBuffer(data, output, decode, threads, options, checksum, stats);
     }
 }
 
+template <typename Alphabet>
+void Base85<Alphabet>::process(int inputFd, int outputFd, Mode mode, bool decode, size_t blockSize,
+                               size_t threads, const EncodeOptions& options, Crc32c* checksum,
+                               Stats* stats) {
+    if (mode == Mode::STREAM) {
+        processStream(inputFd, outputFd, decode, blockSize, options, checksum, stats);
+    } else {
+        Stopwatch watch;
+        std::string data = RawFile::borrow(inputFd, "input").readAll();
+        if (stats != nullptr) {
+            stats->addIoTime(watch.lap());
+        }
+        processBuffer(data, outputFd, decode, threads, options, checksum, stats);
+    }
+}
+
+template class Base85<alphabet::Adobe>;
+template class Base85<alphabet::Btoa>;
+template class Base85<alphabet::Z85>;
+template class Base85<alphabet::Rfc1924>;
+
 } // namespace ascii85
\ No newline at end of file
@@ -0,0 +1,438 @@
+#include "ascii85.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace ascii85 {
+
+namespace {
+
+// Chars that make up groups; whitespace and shortcuts do not count
+template <typename Alphabet>
+inline bool isDigit(char c) {
+    return (DECODING_TABLE_OF<Alphabet>[static_cast<unsigned char>(c)] & NOT_DIGIT) == 0;
+}
+
+// Shortcut chars, each a whole group of its own
+template <typename Alphabet>
+inline bool isShortcut(char c) {
+    uint8_t entry = DECODING_TABLE_OF<Alphabet>[static_cast<unsigned char>(c)];
+    return entry == (NOT_DIGIT | ZERO_GROUP) || entry == (NOT_DIGIT | SPACE_GROUP);
+}
+
+template <typename Alphabet>
+inline bool isWhitespace(char c) {
+    return DECODING_TABLE_OF<Alphabet>[static_cast<unsigned char>(c)] == (NOT_DIGIT | WHITESPACE);
+}
+
+// Narrows [begin, end) to the data between optional "<~" and "~>"
+// delimiters, skipping the whitespace around them
+template <typename Alphabet>
+void stripFrame(const char* data, size_t& begin, size_t& end) {
+    if (!Alphabet::FRAMES) {
+        return;
+    }
+
+    size_t first = begin;
+    while (first < end && isWhitespace<Alphabet>(data[first])) {
+        first++;
+    }
+    if (end - first >= 2 && data[first] == '<' && data[first + 1] == '~') {
+        begin = first + 2;
+    }
+
+    size_t last = end;
+    while (last > begin && isWhitespace<Alphabet>(data[last - 1])) {
+        last--;
+    }
+    if (last - begin >= 2 && data[last - 2] == '~' && data[last - 1] == '>') {
+        end = last - 2;
+    }
+}
+
+// Position just past the `count`-th digit in [from, end), or `end` if
+// there are fewer digits than that
+template <typename Alphabet>
+size_t skipDigits(const char* data, size_t from, size_t end, size_t count) {
+    if (count == 0) {
+        return from;
+    }
+    for (size_t i = from; i < end; i++) {
+        if (isDigit<Alphabet>(data[i]) && --count == 0) {
+            return i + 1;
+        }
+    }
+    return end;
+}
+
+// Splits [0, length) into `chunks` ranges whose boundaries are multiples of `align`
+std::vector<size_t> splitRanges(size_t length, size_t chunks, size_t align) {
+    size_t chunkSize = (length / chunks + align - 1) / align * align;
+    std::vector<size_t> bounds(chunks + 1, length);
+    for (size_t i = 0; i < chunks; i++) {
+        bounds[i] = std::min(i * chunkSize, length);
+    }
+    return bounds;
+}
+
+// Output layout of a parallel run: chunk i of the input is
+// [bounds[i], bounds[i + 1]) and its output starts at offsets[i];
+// offsets[chunks] is the total output size
+struct Plan {
+    std::vector<size_t> bounds;
+    std::vector<size_t> offsets;
+    std::vector<size_t> digitsBefore;
+    size_t shortcuts = 0;
+};
+
+size_t resolveThreads(size_t threads) {
+    return threads == 0 ? ThreadPool::defaultThreadCount() : threads;
+}
+
+// Single-threaded encode and decode that feed `checksum` as they go
+template <typename Alphabet>
+size_t encodeSerial(const uint8_t* input, size_t length, char* output,
+                    const EncodeOptions& options, Crc32c* checksum) {
+    if (checksum == nullptr) {
+        return Base85<Alphabet>::encode(input, length, output, options);
+    }
+    typename Base85<Alphabet>::Encoder encoder(options);
+    encoder.setChecksum(checksum);
+    size_t written = encoder.update(input, length, output);
+    return written + encoder.finish(output + written);
+}
+
+template <typename Alphabet>
+size_t decodeSerial(const char* input, size_t length, uint8_t* output, Crc32c* checksum,
+                    bool trusted, uint64_t* shortcuts) {
+    typename Base85<Alphabet>::Decoder decoder(trusted);
+    decoder.setChecksum(checksum);
+    size_t written = decoder.feed(input, length, output);
+    written += decoder.finish(output + written);
+    if (shortcuts != nullptr) {
+        *shortcuts += decoder.shortcuts();
+    }
+    return written;
+}
+
+// Folds the per-chunk digests into `checksum` in order; chunk i covered
+// ends[i + 1] - ends[i] bytes
+void combineSums(Crc32c* checksum, const std::vector<Crc32c>& sums,
+                 const std::vector<size_t>& ends) {
+    for (size_t i = 0; i < sums.size(); i++) {
+        checksum->append(sums[i].value(), ends[i + 1] - ends[i]);
+    }
+}
+
+// Encoded output of every chunk is 5 chars per group, minus 4 for every
+// group that collapses to a shortcut; count those to place the chunks
+template <typename Alphabet>
+Plan planEncode(const uint8_t* input, size_t length, ThreadPool& pool) {
+    Plan plan;
+    plan.bounds = splitRanges(length, pool.size(), 4);
+    size_t chunks = plan.bounds.size() - 1;
+    std::vector<size_t> sizes(chunks);
+
+    pool.parallelFor(chunks, [&](size_t i) {
+        size_t begin = plan.bounds[i];
+        size_t end = plan.bounds[i + 1];
+        size_t shortGroups = 0;
+        for (size_t j = begin; j + 4 <= end; j += 4) {
+            uint32_t value = uint32_t(input[j]) << 24 | uint32_t(input[j + 1]) << 16 |
+                             uint32_t(input[j + 2]) << 8 | input[j + 3];
+            shortGroups += (Alphabet::ZERO_CHAR != 0 && value == 0) ||
+                           (Alphabet::SPACE_CHAR != 0 && value == 0x20202020);
+        }
+        sizes[i] = Base85<Alphabet>::encodedSizeBound(end - begin) - 4 * shortGroups;
+    });
+
+    plan.offsets.assign(chunks + 1, 0);
+    for (size_t i = 0; i < chunks; i++) {
+        plan.offsets[i + 1] = plan.offsets[i] + sizes[i];
+    }
+    return plan;
+}
+
+// With `sums`, every chunk is encoded and summed slice by slice into its own digest
+template <typename Alphabet>
+void runEncode(const uint8_t* input, char* output, const Plan& plan, ThreadPool& pool,
+               std::vector<Crc32c>* sums) {
+    pool.parallelFor(plan.bounds.size() - 1, [&](size_t i) {
+        size_t begin = plan.bounds[i];
+        size_t end = plan.bounds[i + 1];
+        if (sums == nullptr) {
+            Base85<Alphabet>::encode(input + begin, end - begin, output + plan.offsets[i]);
+            return;
+        }
+
+        char* out = output + plan.offsets[i];
+        for (size_t j = begin; j < end; j += Base85<Alphabet>::CHECKSUM_SLICE) {
+            size_t count = std::min(end - j, Base85<Alphabet>::CHECKSUM_SLICE);
+            out += Base85<Alphabet>::encode(input + j, count, out);
+            (*sums)[i].update(input + j, count);
+        }
+    });
+}
+
+// With line breaks, text char k (delimiters included) is preceded by
+// (k - 1) / width newlines, and an encoder that starts at it continues a
+// line that already holds (k - 1) % width + 1 chars. Without them the
+// whole text is one line.
+size_t wrappedStart(size_t k, size_t width) {
+    return width == 0 || k == 0 ? k : k + (k - 1) / width;
+}
+
+size_t wrappedColumn(size_t k, size_t width) {
+    return width == 0 || k == 0 ? k : (k - 1) % width + 1;
+}
+
+// Every chunk continues the text at its own position; the first one opens
+// the frame and the last one closes it. Returns the total output size.
+template <typename Alphabet>
+size_t runEncodeWrapped(const uint8_t* input, char* output, const Plan& plan,
+                        const EncodeOptions& options, ThreadPool& pool,
+                        std::vector<Crc32c>* sums) {
+    size_t chunks = plan.bounds.size() - 1;
+    size_t prefix = options.frame ? 2 : 0;
+    size_t width = options.effectiveLineWidth();
+    size_t total = 0;
+
+    pool.parallelFor(chunks, [&](size_t i) {
+        size_t begin = plan.bounds[i];
+        size_t k = i == 0 ? 0 : prefix + plan.offsets[i];
+        size_t start = wrappedStart(k, width);
+
+        typename Base85<Alphabet>::Encoder encoder(options, wrappedColumn(k, width));
+        encoder.setChecksum(sums != nullptr ? &(*sums)[i] : nullptr);
+        size_t written = encoder.update(input + begin, plan.bounds[i + 1] - begin, output + start);
+        if (i == chunks - 1) {
+            written += encoder.finish(output + start + written);
+            total = start + written;
+        }
+    });
+    return total;
+}
+
+// Groups can straddle chunk boundaries and shortcuts expand to 4 bytes, so
+// the output position of a chunk follows from how many digits and shortcut
+// chars precede it. Chunk i owns every group whose first digit it holds.
+template <typename Alphabet>
+Plan planDecode(const char* input, size_t length, ThreadPool& pool) {
+    Plan plan;
+    plan.bounds = splitRanges(length, pool.size(), 1);
+    size_t chunks = plan.bounds.size() - 1;
+    std::vector<size_t> digits(chunks);
+    std::vector<size_t> zeros(chunks);
+
+    pool.parallelFor(chunks, [&](size_t i) {
+        size_t digitCount = 0;
+        size_t zeroCount = 0;
+        for (size_t j = plan.bounds[i]; j < plan.bounds[i + 1]; j++) {
+            digitCount += isDigit<Alphabet>(input[j]);
+            zeroCount += isShortcut<Alphabet>(input[j]);
+        }
+        digits[i] = digitCount;
+        zeros[i] = zeroCount;
+    });
+
+    plan.digitsBefore.assign(chunks + 1, 0);
+    plan.offsets.assign(chunks + 1, 0);
+    for (size_t i = 0; i < chunks; i++) {
+        plan.digitsBefore[i + 1] = plan.digitsBefore[i] + digits[i];
+        plan.shortcuts += zeros[i];
+        size_t groupsStarted = (plan.digitsBefore[i + 1] + 4) / 5;
+        plan.offsets[i + 1] = 4 * (groupsStarted + plan.shortcuts);
+    }
+
+    // A trailing partial group of n digits yields n - 1 bytes, not 4. The
+    // chunk holding its first digit decodes it, so every chunk end from
+    // there on moves back; chunks after it may have no digits at all.
+    size_t tailDigits = plan.digitsBefore[chunks] % 5;
+    if (tailDigits > 0) {
+        size_t tailStart = plan.digitsBefore[chunks] - tailDigits;
+        for (size_t i = 1; i <= chunks; i++) {
+            if (plan.digitsBefore[i] > tailStart) {
+                plan.offsets[i] -= 5 - tailDigits;
+            }
+        }
+    }
+    return plan;
+}
+
+// With `sums`, every chunk is decoded and summed slice by slice into its own digest
+template <typename Alphabet>
+void runDecode(const char* input, size_t length, uint8_t* output, const Plan& plan,
+               ThreadPool& pool, std::vector<Crc32c>* sums, bool trusted) {
+    pool.parallelFor(plan.bounds.size() - 1, [&](size_t i) {
+        size_t begin = plan.bounds[i];
+        size_t end = plan.bounds[i + 1];
+
+        // The leading digits finish a group owned by an earlier chunk
+        size_t headDigits = (5 - plan.digitsBefore[i] % 5) % 5;
+        size_t chunkDigits = plan.digitsBefore[i + 1] - plan.digitsBefore[i];
+        if (chunkDigits < headDigits) {
+            return;
+        }
+        size_t start = skipDigits<Alphabet>(input, begin, end, headDigits);
+
+        // A group started here may run into the following chunks
+        size_t pendingDigits = plan.digitsBefore[i + 1] % 5;
+        size_t stop = pendingDigits == 0 ? end
+                                         : skipDigits<Alphabet>(input, end, length, 5 - pendingDigits);
+
+        // Delimiters are stripped already, so any '~' left is an error;
+        // report it the way the serial decoder would
+        simd::DecodeState state;
+        auto decodeSlice = trusted ? simd::decodeTrusted<Alphabet> : simd::decode<Alphabet>;
+        uint8_t* out = output + plan.offsets[i];
+        size_t slice = sums != nullptr ? Base85<Alphabet>::CHECKSUM_SLICE
+                                       : std::max<size_t>(stop - start, 1);
+        size_t position = start;
+        while (position < stop) {
+            size_t count = std::min(stop - position, slice);
+            uint8_t* sliceStart = out;
+            size_t consumed = decodeSlice(input + position, count, out, state);
+            if (sums != nullptr) {
+                (*sums)[i].update(sliceStart, out - sliceStart);
+            }
+            position += consumed;
+            if (consumed < count) {
+                break;
+            }
+        }
+        if (position < stop) {
+            size_t next = position + 1;
+            if (next < length && input[next] == '>') {
+                throw std::runtime_error("Invalid ASCII85 input: data after end marker");
+            }
+            throw std::runtime_error("Invalid ASCII85 input: character out of range");
+        }
+        uint8_t* tail = out;
+        simd::decodeFinish<Alphabet>(state, out);
+        if (sums != nullptr) {
+            (*sums)[i].update(tail, out - tail);
+        }
+    });
+}
+
+} // namespace
+
+template <typename Alphabet>
+std::string Base85<Alphabet>::encodeParallel(const std::string& input, size_t threads,
+                                             const EncodeOptions& options, Crc32c* checksum) {
+    std::string output(encodedSizeBound(input.length(), options), '\0');
+    size_t written = encodeParallel(reinterpret_cast<const uint8_t*>(input.data()), input.length(),
+                                    &output[0], threads, options, checksum);
+    output.resize(written);
+    return output;
+}
+
+template <typename Alphabet>
+size_t Base85<Alphabet>::encodeParallel(const uint8_t* input, size_t length, char* output,
+                                        size_t threads, const EncodeOptions& options,
+                                        Crc32c* checksum) {
+    threads = resolveThreads(threads);
+    if (threads == 1 || length < MIN_PARALLEL_SIZE) {
+        return encodeSerial<Alphabet>(input, length, output, options, checksum);
+    }
+
+    // Every chunk sums its own input; the digests are combined in order
+    ThreadPool pool(threads);
+    Plan plan = planEncode<Alphabet>(input, length, pool);
+    std::vector<Crc32c> sums(checksum != nullptr ? plan.bounds.size() - 1 : 0);
+    std::vector<Crc32c>* chunkSums = checksum != nullptr ? &sums : nullptr;
+    size_t written;
+    if (options.frame || options.lineWidth != 0) {
+        written = runEncodeWrapped<Alphabet>(input, output, plan, options, pool, chunkSums);
+    } else {
+        runEncode<Alphabet>(input, output, plan, pool, chunkSums);
+        written = plan.offsets.back();
+    }
+    if (checksum != nullptr) {
+        combineSums(checksum, sums, plan.bounds);
+    }
+    return written;
+}
+
+template <typename Alphabet>
+std::string Base85<Alphabet>::decodeParallel(const std::string& input, size_t threads,
+                                             Crc32c* checksum, bool trusted,
+                                             uint64_t* shortcuts) {
+    threads = resolveThreads(threads);
+    if (threads == 1 || input.length() < MIN_PARALLEL_SIZE) {
+        if (checksum == nullptr && shortcuts == nullptr) {
+            return decode(input, trusted);
+        }
+        std::string output(decodedSizeBound(input.length()), '\0');
+        output.resize(decodeSerial<Alphabet>(input.data(), input.length(),
+                                             reinterpret_cast<uint8_t*>(&output[0]), checksum,
+                                             trusted, shortcuts));
+        return output;
+    }
+
+    // The plan gives the exact output size, so no worst-case allocation
+    size_t begin = 0;
+    size_t end = input.length();
+    stripFrame<Alphabet>(input.data(), begin, end);
+    ThreadPool pool(threads);
+    Plan plan = planDecode<Alphabet>(input.data() + begin, end - begin, pool);
+    std::string output(plan.offsets.back(), '\0');
+    std::vector<Crc32c> sums(checksum != nullptr ? plan.bounds.size() - 1 : 0);
+    runDecode<Alphabet>(input.data() + begin, end - begin, reinterpret_cast<uint8_t*>(&output[0]),
+                        plan, pool, checksum != nullptr ? &sums : nullptr, trusted);
+    if (checksum != nullptr) {
+        combineSums(checksum, sums, plan.offsets);
+    }
+    if (shortcuts != nullptr) {
+        *shortcuts += plan.shortcuts;
+    }
+    return output;
+}
+
+template <typename Alphabet>
+size_t Base85<Alphabet>::decodeParallel(const char* input, size_t length, uint8_t* output,
+                                        size_t threads, Crc32c* checksum, bool trusted,
+                                        uint64_t* shortcuts) {
+    threads = resolveThreads(threads);
+    if (threads == 1 || length < MIN_PARALLEL_SIZE) {
+        return decodeSerial<Alphabet>(input, length, output, checksum, trusted, shortcuts);
+    }
+
+    // Every chunk sums its own output; the digests are combined in order
+    size_t begin = 0;
+    size_t end = length;
+    stripFrame<Alphabet>(input, begin, end);
+    ThreadPool pool(threads);
+    Plan plan = planDecode<Alphabet>(input + begin, end - begin, pool);
+    std::vector<Crc32c> sums(checksum != nullptr ? plan.bounds.size() - 1 : 0);
+    runDecode<Alphabet>(input + begin, end - begin, output, plan, pool,
+                        checksum != nullptr ? &sums : nullptr, trusted);
+    if (checksum != nullptr) {
+        combineSums(checksum, sums, plan.offsets);
+    }
+    if (shortcuts != nullptr) {
+        *shortcuts += plan.shortcuts;
+    }
+    return plan.offsets.back();
+}
+
+// The parallel members of every variant the library instantiates
+#define ASCII85_INSTANTIATE_PARALLEL(Alphabet)                                                  \
+    template std::string Base85<Alphabet>::encodeParallel(const std::string&, size_t,          \
+                                                          const EncodeOptions&, Crc32c*);     \
+    template size_t Base85<Alphabet>::encodeParallel(const uint8_t*, size_t, char*, size_t,    \
+                                                     const EncodeOptions&, Crc32c*);          \
+    template std::string Base85<Alphabet>::decodeParallel(const std::string&, size_t,         \
+                                                          Crc32c*, bool, uint64_t*);          \
+    template size_t Base85<Alphabet>::decodeParallel(const char*, size_t, uint8_t*, size_t,    \
+                                                     Crc32c*, bool, uint64_t*);
+
+ASCII85_INSTANTIATE_PARALLEL(alphabet::Adobe)
+ASCII85_INSTANTIATE_PARALLEL(alphabet::Btoa)
+ASCII85_INSTANTIATE_PARALLEL(alphabet::Z85)
+ASCII85_INSTANTIATE_PARALLEL(alphabet::Rfc1924)
+
+#undef ASCII85_INSTANTIATE_PARALLEL
+
+} // namespace ascii85
@@ -0,0 +1,259 @@
+#include "ascii85.hpp"
+#include "raw_file.hpp"
+#include "spsc_ring.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace ascii85 {
+
+namespace {
+
+// One unit of work, recycled from the writer back to the reader
+struct Block {
+    Block(size_t inputSize, size_t outputSize) : input(inputSize), output(outputSize) {}
+
+    AlignedBuffer input;
+    AlignedBuffer output;
+    size_t count = 0;   // input bytes
+    size_t written = 0; // output bytes
+    bool last = false;  // the input ends with this block
+    Crc32c digest;      // of the input, when workers sum blocks on their own
+};
+
+using Ring = SpscRing<Block*>;
+
+// Pops from `ring`, spinning briefly and then backing off, until a block
+// arrives or another stage has failed
+bool waitPop(Ring& ring, Block*& block, const std::atomic<bool>& aborted) {
+    for (unsigned attempt = 0; !ring.tryPop(block); attempt++) {
+        if (aborted.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (attempt < 64) {
+            continue;
+        } else if (attempt < 256) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    return true;
+}
+
+// Every ring can hold all the blocks (and the end marker), so pushes never wait
+void push(Ring& ring, Block* block) {
+    if (!ring.tryPush(block)) {
+        throw std::logic_error("Pipeline ring overflow");
+    }
+}
+
+} // namespace
+
+template <typename Alphabet>
+void Base85<Alphabet>::processPipeline(int inputFd, int outputFd, bool decode, size_t blockSize,
+                                       size_t workers, size_t depth,
+                                       const EncodeOptions& options, Crc32c* checksum,
+                                       Stats* stats) {
+    if (blockSize == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    if (depth == 0) {
+        throw std::invalid_argument("Pipeline depth must be positive");
+    }
+
+    RawFile input = RawFile::borrow(inputFd, "input");
+    RawFile output = RawFile::borrow(outputFd, "output");
+    if (!decode && input.isTerminal()) {
+        processStream(inputFd, outputFd, decode, blockSize, options, checksum, stats);
+        return;
+    }
+
+    // Blocks are coded independently only when no state crosses them: plain
+    // encoding of whole groups. Those blocks are filled to a multiple of 4.
+    bool independent = !decode && !options.frame && options.lineWidth == 0;
+    if (workers == 0) {
+        workers = ThreadPool::defaultThreadCount();
+    }
+    workers = independent ? std::min(workers, depth) : 1;
+    independent = workers > 1;
+    if (independent) {
+        blockSize = (blockSize + 3) / 4 * 4;
+    }
+
+    // Room for the block plus what finish() adds after the last one
+    size_t outputSize = std::max(decodedSizeBound(blockSize) + 4,
+                                 encodedSizeBound(blockSize + 3, options) +
+                                     encodedSizeBound(3, options));
+    std::vector<std::unique_ptr<Block>> blocks;
+    Ring freeBlocks(depth);
+    for (size_t i = 0; i < depth; i++) {
+        blocks.push_back(std::make_unique<Block>(blockSize, outputSize));
+        push(freeBlocks, blocks.back().get());
+    }
+
+    // Block k goes to worker k % workers and comes back from it in turn,
+    // so each ring has a single producer and a single consumer
+    std::vector<std::unique_ptr<Ring>> work;
+    std::vector<std::unique_ptr<Ring>> done;
+    for (size_t w = 0; w < workers; w++) {
+        work.push_back(std::make_unique<Ring>(depth + 1));
+        done.push_back(std::make_unique<Ring>(depth));
+    }
+
+    std::atomic<bool> aborted(false);
+
+    // Tallies of the stages, each written by its own thread only and added
+    // to `stats` once they have all finished
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t readTime = 0;
+    uint64_t writeTime = 0;
+    std::vector<uint64_t> shortcuts(workers);
+    std::vector<uint64_t> codecTimes(workers);
+
+    auto reader = [&] {
+        for (size_t sequence = 0;; sequence++) {
+            Block* block;
+            if (!waitPop(freeBlocks, block, aborted)) {
+                return;
+            }
+
+            // A short read is passed on as is, unless it splits a group
+            Stopwatch watch;
+            block->count = 0;
+            block->last = false;
+            while (block->count < blockSize) {
+                size_t count = input.read(block->input.data() + block->count,
+                                          blockSize - block->count);
+                if (count == 0) {
+                    block->last = true;
+                    break;
+                }
+                block->count += count;
+                if (!independent || block->count % 4 == 0) {
+                    break;
+                }
+            }
+            readTime += watch.lap();
+            bytesRead += block->count;
+            bool last = block->last;
+            push(*work[sequence % workers], block);
+
+            if (last) {
+                for (auto& ring : work) {
+                    push(*ring, nullptr);
+                }
+                return;
+            }
+        }
+    };
+
+    auto worker = [&](size_t w) {
+        Encoder encoder(options);
+        Decoder decoder(options.trusted);
+        encoder.setChecksum(checksum);
+        decoder.setChecksum(checksum);
+
+        Block* block;
+        while (waitPop(*work[w], block, aborted) && block != nullptr) {
+            Stopwatch watch;
+            const char* in = block->input.data();
+            char* out = block->output.data();
+            if (independent) {
+                block->digest = Crc32c();
+                block->written = encodeParallel(reinterpret_cast<const uint8_t*>(in), block->count,
+                                                out, 1, options,
+                                                checksum != nullptr ? &block->digest : nullptr);
+            } else if (decode) {
+                uint8_t* bytes = reinterpret_cast<uint8_t*>(out);
+                block->written = decoder.feed(in, block->count, bytes);
+                if (block->last) {
+                    block->written += decoder.finish(bytes + block->written);
+                }
+            } else {
+                block->written = encoder.update(reinterpret_cast<const uint8_t*>(in),
+                                                block->count, out);
+                if (block->last) {
+                    block->written += encoder.finish(out + block->written);
+                }
+            }
+            codecTimes[w] += watch.lap();
+            push(*done[w], block);
+        }
+        shortcuts[w] = decoder.shortcuts();
+    };
+
+    auto writer = [&] {
+        for (size_t sequence = 0;; sequence++) {
+            Block* block;
+            if (!waitPop(*done[sequence % workers], block, aborted)) {
+                return;
+            }
+            Stopwatch watch;
+            output.write(block->output.data(), block->written);
+            writeTime += watch.lap();
+            bytesWritten += block->written;
+            if (independent && checksum != nullptr) {
+                checksum->append(block->digest.value(), block->count);
+            }
+            bool last = block->last;
+            push(freeBlocks, block);
+            if (last) {
+                return;
+            }
+        }
+    };
+
+    // A failing stage stops the others, and its exception is rethrown here
+    ThreadPool pool(workers + 2);
+    pool.parallelFor(workers + 2, [&](size_t stage) {
+        try {
+            if (stage == 0) {
+                reader();
+            } else if (stage == 1) {
+                writer();
+            } else {
+                worker(stage - 2);
+            }
+        } catch (...) {
+            aborted = true;
+            throw;
+        }
+    });
+
+    if (stats != nullptr) {
+        uint64_t total = 0;
+        for (size_t w = 0; w < workers; w++) {
+            total += shortcuts[w];
+            stats->addCodecTime(codecTimes[w]);
+        }
+        if (decode) {
+            stats->addDecoded(bytesRead, bytesWritten, total);
+        } else {
+            stats->addEncoded(bytesRead, bytesWritten,
+                              Stats::lineBreaks(bytesWritten, options.effectiveLineWidth()),
+                              options.frame);
+        }
+        stats->addIoTime(readTime + writeTime);
+        stats->noteBuffer(depth * (blockSize + outputSize));
+    }
+}
+
+#define ASCII85_INSTANTIATE_PIPELINE(Alphabet)                                                  \
+    template void Base85<Alphabet>::processPipeline(int, int, bool, size_t, size_t, size_t,     \
+                                                    const EncodeOptions&, Crc32c*, Stats*);
+
+ASCII85_INSTANTIATE_PIPELINE(alphabet::Adobe)
+ASCII85_INSTANTIATE_PIPELINE(alphabet::Btoa)
+ASCII85_INSTANTIATE_PIPELINE(alphabet::Z85)
+ASCII85_INSTANTIATE_PIPELINE(alphabet::Rfc1924)
+
+#undef ASCII85_INSTANTIATE_PIPELINE
+
+} // namespace ascii85
@@ -0,0 +1,1112 @@
+#include "ascii85_simd.hpp"
+#include "ascii85.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ASCII85_X86 1
+#include <immintrin.h>
+#else
+#define ASCII85_X86 0
+#endif
+
+namespace ascii85 {
+namespace simd {
+
+template <typename Alphabet>
+size_t encodeScalar(const uint8_t* input, size_t length, char*& output) {
+    char* out = output;
+
+    // Process input in chunks of 4 bytes
+    for (size_t i = 0; i < length; i += 4) {
+        // Determine how many bytes we have in this chunk (1-4)
+        size_t bytesInChunk = std::min(length - i, size_t(4));
+
+        // Calculate the 32-bit value for these bytes (big-endian)
+        uint32_t value = 0;
+        for (size_t j = 0; j < bytesInChunk; j++) {
+            value |= static_cast<uint32_t>(input[i + j]) << (8 * (3 - j));
+        }
+
+        // Special cases: all zeros, all spaces
+        if (Alphabet::ZERO_CHAR != 0 && value == 0 && bytesInChunk == 4) {
+            *out++ = Alphabet::ZERO_CHAR;
+            continue;
+        }
+        if (Alphabet::SPACE_CHAR != 0 && value == 0x20202020 && bytesInChunk == 4) {
+            *out++ = Alphabet::SPACE_CHAR;
+            continue;
+        }
+
+        // Convert value to base-85 (5 characters), least significant digit last
+        char encoded[5];
+        for (int j = 4; j >= 0; j--) {
+            encoded[j] = Alphabet::DIGITS[value % 85];
+            value /= 85;
+        }
+
+        // Output only as many characters as needed (n+1 for n input bytes)
+        std::memcpy(out, encoded, bytesInChunk + 1);
+        out += bytesInChunk + 1;
+    }
+
+    output = out;
+    return length;
+}
+
+namespace {
+
+// Largest value of the first four digits of a group that still fits in
+// 32 bits once the fifth digit is appended (85 * 50529027 == 0xFFFFFFFF)
+constexpr uint32_t MAX_GROUP_PREFIX = 0xFFFFFFFFu / 85;
+
+// Writes the 4 bytes of a complete group of digits (0-84)
+inline void emitGroup(const uint8_t* digits, uint8_t*& out) {
+    uint64_t value = 0;
+    for (int j = 0; j < 5; j++) {
+        value = value * 85 + digits[j];
+    }
+    if (value > 0xFFFFFFFF) {
+        throw std::runtime_error("Invalid ASCII85 input: value overflow");
+    }
+    for (int j = 0; j < 4; j++) {
+        *out++ = static_cast<uint8_t>(value >> (8 * (3 - j)));
+    }
+}
+
+} // namespace
+
+namespace {
+
+// Chars decoded per staging block; errors are checked once per block
+constexpr size_t SCALAR_BLOCK = 256;
+
+// What a block ran into, accumulated over all of its chars
+enum BlockFlags : unsigned {
+    BAD_CHAR = 1,   // char outside the alphabet
+    BAD_ZERO = 2,   // zero shortcut inside a group
+    BAD_VALUE = 4,  // group value above 2^32 - 1
+    STOP = 8,       // '~' of an end marker
+    BAD_SPACE = 16  // space shortcut inside a group
+};
+
+// Decodes a block into `out` without a single data-dependent branch: the
+// table entry decides through arithmetic whether a char adds a digit,
+// finishes a group or expands a shortcut. `value` and `count` carry the
+// group being collected; `shortcuts` counts the shortcut chars.
+template <typename Alphabet>
+unsigned decodeBlock(const char* input, size_t length, uint8_t*& out, uint64_t& value,
+                     unsigned& count, uint64_t& shortcuts) {
+    const auto& table = DECODING_TABLE_OF<Alphabet>;
+    unsigned flags = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t entry = table[static_cast<unsigned char>(input[i])];
+        unsigned digit = (entry & NOT_DIGIT) == 0;
+        unsigned zero = Alphabet::ZERO_CHAR != 0 && entry == (NOT_DIGIT | ZERO_GROUP);
+        unsigned space = Alphabet::SPACE_CHAR != 0 && entry == (NOT_DIGIT | SPACE_GROUP);
+
+        flags |= (entry == (NOT_DIGIT | INVALID)) * BAD_CHAR;
+        flags |= (zero & (count != 0)) * BAD_ZERO;
+        flags |= (space & (count != 0)) * BAD_SPACE;
+        flags |= (entry == (NOT_DIGIT | FRAME_END)) * STOP;
+
+        value = digit ? value * 85 + entry : value;
+        count += digit;
+        unsigned full = count == 5;
+        flags |= (full & (value > 0xFFFFFFFF)) * BAD_VALUE;
+
+        // A finished group stores its value, a shortcut its fixed word;
+        // the store is unconditional and only the advance depends on it
+        uint32_t word = full ? static_cast<uint32_t>(value) : space * 0x20202020u;
+        out[0] = static_cast<uint8_t>(word >> 24);
+        out[1] = static_cast<uint8_t>(word >> 16);
+        out[2] = static_cast<uint8_t>(word >> 8);
+        out[3] = static_cast<uint8_t>(word);
+        out += 4 * (full | zero | space);
+        shortcuts += zero | space;
+        value = full ? 0 : value;
+        count = full ? 0 : count;
+    }
+
+    return flags;
+}
+
+// "'z' character in wrong context" and the like
+std::runtime_error misplacedShortcut(char shortcut) {
+    return std::runtime_error(std::string("Invalid ASCII85 input: '") + shortcut +
+                              "' character in wrong context");
+}
+
+} // namespace
+
+template <typename Alphabet>
+size_t decodeScalar(const char* input, size_t length, uint8_t*& output, DecodeState& state) {
+    // Bytes are staged so that nothing reaches `output` for a block that
+    // turns out to be malformed
+    uint8_t stage[4 * SCALAR_BLOCK];
+    uint64_t value = 0;
+    for (int j = 0; j < state.count; j++) {
+        value = value * 85 + state.digits[j];
+    }
+    unsigned count = state.count;
+    uint64_t shortcuts = state.shortcuts;
+
+    size_t begin = 0;
+    while (begin < length) {
+        size_t end = std::min(length, begin + SCALAR_BLOCK);
+        uint64_t blockValue = value;
+        unsigned blockCount = count;
+        uint64_t blockShortcuts = shortcuts;
+        uint8_t* out = stage;
+        unsigned flags = decodeBlock<Alphabet>(input + begin, end - begin, out, value, count,
+                                               shortcuts);
+
+        // The data ends at a '~': decode the block again up to it
+        if (flags & STOP) {
+            end = static_cast<const char*>(std::memchr(input + begin, '~', end - begin)) - input;
+            value = blockValue;
+            count = blockCount;
+            shortcuts = blockShortcuts;
+            out = stage;
+            flags = decodeBlock<Alphabet>(input + begin, end - begin, out, value, count,
+                                          shortcuts);
+            length = end;
+        }
+
+        if (flags != 0) {
+            // A block can hold several errors; report the first one in the
+            // input, as a char-by-char decoder would
+            value = blockValue;
+            count = blockCount;
+            for (size_t i = begin; i < end; i++) {
+                out = stage;
+                flags = decodeBlock<Alphabet>(input + i, 1, out, value, count, shortcuts);
+                if (flags != 0) {
+                    break;
+                }
+            }
+
+            state.count = 0;
+            if (flags & BAD_CHAR) {
+                throw std::runtime_error("Invalid ASCII85 input: character out of range");
+            }
+            if (flags & BAD_ZERO) {
+                throw misplacedShortcut(Alphabet::ZERO_CHAR);
+            }
+            if (flags & BAD_SPACE) {
+                throw misplacedShortcut(Alphabet::SPACE_CHAR);
+            }
+            throw std::runtime_error("Invalid ASCII85 input: value overflow");
+        }
+
+        size_t written = out - stage;
+        std::memcpy(output, stage, written);
+        output += written;
+        begin = end;
+    }
+
+    // Hand the digits of an unfinished group back to the state
+    state.shortcuts = shortcuts;
+    state.count = static_cast<int>(count);
+    for (int j = state.count - 1; j >= 0; j--) {
+        state.digits[j] = static_cast<uint8_t>(value % 85);
+        value /= 85;
+    }
+    return length;
+}
+
+template <typename Alphabet>
+void decodeFinish(DecodeState& state, uint8_t*& output) {
+    if (state.count == 0) {
+        return;
+    }
+
+    // A single character group is always invalid, and so is any partial
+    // group where the variant has none
+    if (state.count == 1 || !Alphabet::PARTIAL_GROUPS) {
+        state.count = 0;
+        throw std::runtime_error("Invalid ASCII85 input: incomplete group");
+    }
+
+    // Pad with 'u' and keep only the n-1 bytes the n chars encode
+    int bytesToOutput = state.count - 1;
+    for (int j = state.count; j < 5; j++) {
+        state.digits[j] = 84; // the highest digit ('u' in Adobe ASCII85)
+    }
+    uint8_t group[4];
+    uint8_t* groupOut = group;
+    emitGroup(state.digits, groupOut);
+
+    std::memcpy(output, group, bytesToOutput);
+    output += bytesToOutput;
+    state.count = 0;
+}
+
+template <typename Alphabet>
+size_t decodeTrustedScalar(const char* input, size_t length, uint8_t*& output,
+                           DecodeState& state) {
+    if (Alphabet::FRAMES) {
+        const void* end = std::memchr(input, '~', length);
+        length = end != nullptr ? static_cast<const char*>(end) - input : length;
+    }
+
+    // Like decodeScalar, minus the checks on the error flags. The block
+    // decoder stores 4 bytes for every char and only advances past finished
+    // groups, so it writes into a stage: straight into `output` it would
+    // overrun an exactly sized buffer, or the next chunk of a parallel decode.
+    uint8_t stage[4 * SCALAR_BLOCK];
+    uint64_t value = 0;
+    for (int j = 0; j < state.count; j++) {
+        value = value * 85 + state.digits[j];
+    }
+    unsigned count = state.count;
+    uint64_t shortcuts = state.shortcuts;
+
+    for (size_t begin = 0; begin < length; begin += SCALAR_BLOCK) {
+        size_t end = std::min(length, begin + SCALAR_BLOCK);
+        uint8_t* out = stage;
+        decodeBlock<Alphabet>(input + begin, end - begin, out, value, count, shortcuts);
+        size_t written = out - stage;
+        std::memcpy(output, stage, written);
+        output += written;
+    }
+
+    state.shortcuts = shortcuts;
+    state.count = static_cast<int>(count);
+    for (int j = state.count - 1; j >= 0; j--) {
+        state.digits[j] = static_cast<uint8_t>(value % 85);
+        value /= 85;
+    }
+    return length;
+}
+
+#if ASCII85_X86
+
+namespace {
+
+// 2^38 / 85 rounded up: (x * MAGIC) >> 38 == x / 85 for every 32-bit x
+constexpr uint32_t DIV85_MAGIC = 0xC0C0C0C1u;
+
+// Whether digit d is written as '!' + d, which saves the table lookups
+constexpr bool isOffsetAlphabet(const char* digits) {
+    for (int i = 0; i < 85; i++) {
+        if (digits[i] != '!' + i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Chars of digits 0-84, padded to six 16-byte pshufb tables
+template <typename Alphabet>
+constexpr std::array<char, 96> makeDigitTable() {
+    std::array<char, 96> table{};
+    for (int i = 0; i < 85; i++) {
+        table[i] = Alphabet::DIGITS[i];
+    }
+    return table;
+}
+
+template <typename Alphabet>
+constexpr std::array<char, 96> DIGIT_TABLE = makeDigitTable<Alphabet>();
+
+// Maps ASCII onto the Adobe alphabet, so that the decoder kernels only ever
+// see '!' + digit: digits become '!' + value, whitespace stays as it is and
+// everything else becomes 0xFF, which stops the kernels
+template <typename Alphabet>
+constexpr std::array<uint8_t, 128> makeTranslationTable() {
+    std::array<uint8_t, 128> table{};
+    for (int c = 0; c < 128; c++) {
+        uint8_t entry = DECODING_TABLE_OF<Alphabet>[c];
+        table[c] = entry < 85 ? static_cast<uint8_t>('!' + entry)
+                 : entry == (NOT_DIGIT | WHITESPACE) ? static_cast<uint8_t>(c)
+                 : 0xFF;
+    }
+    return table;
+}
+
+template <typename Alphabet>
+constexpr std::array<uint8_t, 128> TRANSLATION_TABLE = makeTranslationTable<Alphabet>();
+
+// Writes `count` groups. Lane g of `head` holds the four leading chars of
+// group g (first char in the low byte), lane g of `tail` holds the last one.
+// Bits g of `zeroMask` and `spaceMask` mark groups that collapse to a
+// shortcut.
+template <typename Alphabet>
+inline void emitGroups(const uint32_t* head, const uint32_t* tail, unsigned zeroMask,
+                       unsigned spaceMask, int count, char*& out) {
+    for (int g = 0; g < count; g++) {
+        if ((zeroMask | spaceMask) & (1u << g)) {
+            *out++ = zeroMask & (1u << g) ? Alphabet::ZERO_CHAR : Alphabet::SPACE_CHAR;
+            continue;
+        }
+        std::memcpy(out, &head[g], 4);
+        out[4] = static_cast<char>(tail[g]);
+        out += 5;
+    }
+}
+
+__attribute__((target("sse4.1")))
+inline __m128i div85SSE41(__m128i x) {
+    const __m128i magic = _mm_set1_epi32(static_cast<int>(DIV85_MAGIC));
+    __m128i even = _mm_srli_epi64(_mm_mul_epu32(x, magic), 38);
+    __m128i odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(x, 32), magic), 38);
+    return _mm_blend_epi16(even, _mm_slli_epi64(odd, 32), 0xCC);
+}
+
+__attribute__((target("avx2")))
+inline __m256i div85AVX2(__m256i x) {
+    const __m256i magic = _mm256_set1_epi32(static_cast<int>(DIV85_MAGIC));
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, magic), 38);
+    __m256i odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), magic), 38);
+    return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+}
+
+// Chars of the digits (0-84) in every byte, 16 pshufb lookups at a time
+// keyed by the high nibble
+template <typename Alphabet>
+__attribute__((target("sse4.1")))
+inline __m128i digitCharsSSE41(__m128i digits) {
+    if constexpr (isOffsetAlphabet(Alphabet::DIGITS)) {
+        return _mm_add_epi8(digits, _mm_set1_epi8('!'));
+    } else {
+        __m128i high = _mm_and_si128(_mm_srli_epi16(digits, 4), _mm_set1_epi8(0x0F));
+        __m128i chars = _mm_setzero_si128();
+        for (int k = 0; k < 6; k++) {
+            __m128i table = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(DIGIT_TABLE<Alphabet>.data() + 16 * k));
+            chars = _mm_blendv_epi8(chars, _mm_shuffle_epi8(table, digits),
+                                    _mm_cmpeq_epi8(high, _mm_set1_epi8(static_cast<char>(k))));
+        }
+        return chars;
+    }
+}
+
+template <typename Alphabet>
+__attribute__((target("avx2")))
+inline __m256i digitCharsAVX2(__m256i digits) {
+    if constexpr (isOffsetAlphabet(Alphabet::DIGITS)) {
+        return _mm256_add_epi8(digits, _mm256_set1_epi8('!'));
+    } else {
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(digits, 4), _mm256_set1_epi8(0x0F));
+        __m256i chars = _mm256_setzero_si256();
+        for (int k = 0; k < 6; k++) {
+            __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(DIGIT_TABLE<Alphabet>.data() + 16 * k)));
+            __m256i select = _mm256_cmpeq_epi8(high, _mm256_set1_epi8(static_cast<char>(k)));
+            chars = _mm256_blendv_epi8(chars, _mm256_shuffle_epi8(table, digits), select);
+        }
+        return chars;
+    }
+}
+
+// Applies TRANSLATION_TABLE to 16 chars, 8 pshufb lookups keyed by the
+// high nibble; bytes of 0x80 and above match none and become 0xFF
+template <typename Alphabet>
+__attribute__((target("sse4.1")))
+inline __m128i translateSSE41(__m128i block) {
+    if constexpr (isOffsetAlphabet(Alphabet::DIGITS)) {
+        return block;
+    } else {
+        __m128i high = _mm_and_si128(_mm_srli_epi16(block, 4), _mm_set1_epi8(0x0F));
+        __m128i result = _mm_set1_epi8(-1);
+        for (int k = 0; k < 8; k++) {
+            __m128i table = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(TRANSLATION_TABLE<Alphabet>.data() + 16 * k));
+            result = _mm_blendv_epi8(result, _mm_shuffle_epi8(table, block),
+                                     _mm_cmpeq_epi8(high, _mm_set1_epi8(static_cast<char>(k))));
+        }
+        return result;
+    }
+}
+
+// Shuffle indices that move the bytes selected by an 8-bit mask to the
+// front of an 8-byte lane; unused slots are 0x80 (pshufb writes zero)
+constexpr std::array<std::array<uint8_t, 8>, 256> makeCompactTable() {
+    std::array<std::array<uint8_t, 8>, 256> table{};
+    for (int mask = 0; mask < 256; mask++) {
+        int k = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            if (mask & (1 << bit)) {
+                table[mask][k++] = static_cast<uint8_t>(bit);
+            }
+        }
+        while (k < 8) {
+            table[mask][k++] = 0x80;
+        }
+    }
+    return table;
+}
+
+constexpr auto COMPACT_TABLE = makeCompactTable();
+
+// Digits are gathered in a staging buffer and decoded once it holds
+// STAGE_FLUSH or more; the slack absorbs one compacted 16-byte block and
+// the over-reads of the group loaders.
+constexpr size_t STAGE_FLUSH = 200;
+constexpr size_t STAGE_SIZE = STAGE_FLUSH + 64;
+
+// Decodes `groups` complete groups of raw chars from `stage`
+using DecodeGroups = void (*)(const uint8_t* stage, size_t groups, uint8_t*& out);
+
+inline void decodeGroupsScalar(const uint8_t* stage, size_t groups, uint8_t*& out) {
+    for (size_t g = 0; g < groups; g++) {
+        uint8_t digits[5];
+        for (int j = 0; j < 5; j++) {
+            digits[j] = stage[5 * g + j] - '!';
+        }
+        emitGroup(digits, out);
+    }
+}
+
+__attribute__((target("sse4.1")))
+void decodeGroupsSSE41(const uint8_t* stage, size_t groups, uint8_t*& out) {
+    const __m128i byteSwap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128i base = _mm_set1_epi32(85);
+    const __m128i offset = _mm_set1_epi32('!');
+    const __m128i maxPrefix = _mm_set1_epi32(static_cast<int>(MAX_GROUP_PREFIX));
+
+    size_t g = 0;
+    for (; g + 4 <= groups; g += 4) {
+        const uint8_t* s = stage + 5 * g;
+        __m128i digits[5];
+        for (int k = 0; k < 5; k++) {
+            digits[k] = _mm_sub_epi32(_mm_setr_epi32(s[k], s[k + 5], s[k + 10], s[k + 15]), offset);
+        }
+
+        __m128i prefix = digits[0];
+        for (int k = 1; k < 4; k++) {
+            prefix = _mm_add_epi32(_mm_mullo_epi32(prefix, base), digits[k]);
+        }
+
+        // prefix * 85 + last must not exceed 0xFFFFFFFF
+        __m128i overflow = _mm_or_si128(
+            _mm_cmpgt_epi32(prefix, maxPrefix),
+            _mm_and_si128(_mm_cmpeq_epi32(prefix, maxPrefix),
+                          _mm_cmpgt_epi32(digits[4], _mm_setzero_si128())));
+        if (!_mm_testz_si128(overflow, overflow)) {
+            throw std::runtime_error("Invalid ASCII85 input: value overflow");
+        }
+
+        __m128i value = _mm_add_epi32(_mm_mullo_epi32(prefix, base), digits[4]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(value, byteSwap));
+        out += 16;
+    }
+
+    decodeGroupsScalar(stage + 5 * g, groups - g, out);
+}
+
+__attribute__((target("avx2")))
+void decodeGroupsAVX2(const uint8_t* stage, size_t groups, uint8_t*& out) {
+    const __m256i byteSwap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                              3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i groupIndex = _mm256_setr_epi32(0, 5, 10, 15, 20, 25, 30, 35);
+    const __m256i lowByte = _mm256_set1_epi32(0xFF);
+    const __m256i base = _mm256_set1_epi32(85);
+    const __m256i offset = _mm256_set1_epi32('!');
+    const __m256i maxPrefix = _mm256_set1_epi32(static_cast<int>(MAX_GROUP_PREFIX));
+
+    size_t g = 0;
+    for (; g + 8 <= groups; g += 8) {
+        const uint8_t* s = stage + 5 * g;
+        __m256i digits[5];
+        for (int k = 0; k < 5; k++) {
+            __m256i raw = _mm256_i32gather_epi32(reinterpret_cast<const int*>(s + k), groupIndex, 1);
+            digits[k] = _mm256_sub_epi32(_mm256_and_si256(raw, lowByte), offset);
+        }
+
+        __m256i prefix = digits[0];
+        for (int k = 1; k < 4; k++) {
+            prefix = _mm256_add_epi32(_mm256_mullo_epi32(prefix, base), digits[k]);
+        }
+
+        // prefix * 85 + last must not exceed 0xFFFFFFFF
+        __m256i overflow = _mm256_or_si256(
+            _mm256_cmpgt_epi32(prefix, maxPrefix),
+            _mm256_and_si256(_mm256_cmpeq_epi32(prefix, maxPrefix),
+                             _mm256_cmpgt_epi32(digits[4], _mm256_setzero_si256())));
+        if (!_mm256_testz_si256(overflow, overflow)) {
+            throw std::runtime_error("Invalid ASCII85 input: value overflow");
+        }
+
+        __m256i value = _mm256_add_epi32(_mm256_mullo_epi32(prefix, base), digits[4]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_shuffle_epi8(value, byteSwap));
+        out += 32;
+    }
+
+    decodeGroupsSSE41(stage + 5 * g, groups - g, out);
+}
+
+// Shared block loop: translates 16 input bytes at a time to the Adobe
+// alphabet and classifies them, compacts the digits of blocks that hold only
+// digits and whitespace into the staging buffer and decodes the staged
+// groups in batches.
+template <typename Alphabet, DecodeGroups decodeGroups>
+__attribute__((target("sse4.1")))
+size_t decodeBlocks(const char* input, size_t length, uint8_t*& output, DecodeState& state) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i last = _mm_set1_epi8('u');
+    const __m128i minusOne = _mm_set1_epi8(-1);
+    const __m128i laneOffset = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 8, 8, 8, 8, 8, 8, 8, 8);
+
+    alignas(16) uint8_t stage[STAGE_SIZE];
+    size_t staged = 0;
+    for (int j = 0; j < state.count; j++) {
+        stage[staged++] = state.digits[j] + '!';
+    }
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = translateSSE41<Alphabet>(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)));
+
+        // Signed compares: bytes >= 0x80 are negative and match neither class
+        __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(block, space),
+                                        _mm_cmpgt_epi8(_mm_add_epi8(last, _mm_set1_epi8(1)), block));
+        __m128i isSpace = _mm_and_si128(_mm_cmpgt_epi8(block, minusOne),
+                                        _mm_cmpgt_epi8(_mm_add_epi8(space, _mm_set1_epi8(1)), block));
+        unsigned digitMask = static_cast<unsigned>(_mm_movemask_epi8(isDigit));
+        unsigned spaceMask = static_cast<unsigned>(_mm_movemask_epi8(isSpace));
+
+        // A shortcut or an invalid char: leave the rest to the scalar path
+        if ((digitMask | spaceMask) != 0xFFFF) {
+            break;
+        }
+
+        if (digitMask == 0xFFFF) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(stage + staged), block);
+            staged += 16;
+        } else {
+            unsigned lowMask = digitMask & 0xFF;
+            unsigned highMask = digitMask >> 8;
+            __m128i shuffle = _mm_unpacklo_epi64(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(COMPACT_TABLE[lowMask].data())),
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(COMPACT_TABLE[highMask].data())));
+            __m128i packed = _mm_shuffle_epi8(block, _mm_add_epi8(shuffle, laneOffset));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(stage + staged), packed);
+            staged += __builtin_popcount(lowMask);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(stage + staged), _mm_unpackhi_epi64(packed, packed));
+            staged += __builtin_popcount(highMask);
+        }
+
+        if (staged >= STAGE_FLUSH) {
+            size_t groups = staged / 5;
+            decodeGroups(stage, groups, output);
+            staged -= groups * 5;
+            std::memmove(stage, stage + groups * 5, staged);
+        }
+    }
+
+    size_t groups = staged / 5;
+    decodeGroups(stage, groups, output);
+    staged -= groups * 5;
+
+    state.count = static_cast<int>(staged);
+    for (size_t j = 0; j < staged; j++) {
+        state.digits[j] = stage[groups * 5 + j] - '!';
+    }
+
+    return i;
+}
+
+// Trusted decoding works on the input in place: a run of 20 chars (SSE4.1)
+// or 40 chars (AVX2) starting at a group boundary and holding only digits
+// is decoded straight into the output, with no staging and no overflow
+// check. Every 16-byte lane covers 4 groups and is loaded twice, at the
+// first group and 4 chars later, so that the fourth group is in reach.
+// The shuffles pick the first four digits of every group into one 32-bit
+// lane and the fifth into another.
+constexpr uint8_t Z = 0x80;
+alignas(16) constexpr uint8_t LEAD_FROM_FIRST[16] = {0, 1, 2, 3, 5, 6, 7, 8, 10, 11, 12, 13, Z, Z, Z, Z};
+alignas(16) constexpr uint8_t LEAD_FROM_SECOND[16] = {Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, 11, 12, 13, 14};
+alignas(16) constexpr uint8_t LAST_FROM_FIRST[16] = {4, Z, Z, Z, 9, Z, Z, Z, 14, Z, Z, Z, Z, Z, Z, Z};
+alignas(16) constexpr uint8_t LAST_FROM_SECOND[16] = {Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, 15, Z, Z, Z};
+
+inline __m128i loadTable(const uint8_t* table) {
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+}
+
+__attribute__((target("avx2")))
+inline __m256i broadcastTable(const uint8_t* table) {
+    return _mm256_broadcastsi128_si256(loadTable(table));
+}
+
+// Bytes that are not a digit once translated to the Adobe alphabet
+__attribute__((target("sse4.1")))
+inline __m128i nonDigitsSSE41(__m128i block) {
+    return _mm_or_si128(_mm_cmpgt_epi8(_mm_set1_epi8('!'), block),
+                        _mm_cmpgt_epi8(block, _mm_set1_epi8('u')));
+}
+
+__attribute__((target("avx2")))
+inline __m256i nonDigitsAVX2(__m256i block) {
+    return _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8('!'), block),
+                           _mm256_cmpgt_epi8(block, _mm256_set1_epi8('u')));
+}
+
+// Values of the 4 groups in `first` (and `second`, 4 chars later), as
+// d0 * 85^4 + ... + d4 with 32-bit wraparound, bytes in output order
+__attribute__((target("sse4.1")))
+inline __m128i groupValuesSSE41(__m128i first, __m128i second) {
+    __m128i offset = _mm_set1_epi8('!');
+    first = _mm_sub_epi8(first, offset);
+    second = _mm_sub_epi8(second, offset);
+    __m128i lead = _mm_or_si128(_mm_shuffle_epi8(first, loadTable(LEAD_FROM_FIRST)),
+                                _mm_shuffle_epi8(second, loadTable(LEAD_FROM_SECOND)));
+    __m128i last = _mm_or_si128(_mm_shuffle_epi8(first, loadTable(LAST_FROM_FIRST)),
+                                _mm_shuffle_epi8(second, loadTable(LAST_FROM_SECOND)));
+
+    // (d0 * 85 + d1) * 85^2 + (d2 * 85 + d3), then * 85 + d4
+    __m128i pairs = _mm_maddubs_epi16(lead, _mm_set1_epi16(85 | 1 << 8));
+    __m128i prefix = _mm_madd_epi16(pairs, _mm_set1_epi32(85 * 85 | 1 << 16));
+    __m128i value = _mm_add_epi32(_mm_mullo_epi32(prefix, _mm_set1_epi32(85)), last);
+    return _mm_shuffle_epi8(value, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+                                                 15, 14, 13, 12));
+}
+
+__attribute__((target("avx2")))
+inline __m256i groupValuesAVX2(__m256i first, __m256i second) {
+    __m256i offset = _mm256_set1_epi8('!');
+    first = _mm256_sub_epi8(first, offset);
+    second = _mm256_sub_epi8(second, offset);
+    __m256i lead = _mm256_or_si256(_mm256_shuffle_epi8(first, broadcastTable(LEAD_FROM_FIRST)),
+                                   _mm256_shuffle_epi8(second, broadcastTable(LEAD_FROM_SECOND)));
+    __m256i last = _mm256_or_si256(_mm256_shuffle_epi8(first, broadcastTable(LAST_FROM_FIRST)),
+                                   _mm256_shuffle_epi8(second, broadcastTable(LAST_FROM_SECOND)));
+
+    __m256i pairs = _mm256_maddubs_epi16(lead, _mm256_set1_epi16(85 | 1 << 8));
+    __m256i prefix = _mm256_madd_epi16(pairs, _mm256_set1_epi32(85 * 85 | 1 << 16));
+    __m256i value = _mm256_add_epi32(_mm256_mullo_epi32(prefix, _mm256_set1_epi32(85)), last);
+    return _mm256_shuffle_epi8(value, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+                                                       15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4,
+                                                       11, 10, 9, 8, 15, 14, 13, 12));
+}
+
+// Completes a group carried over in `state` if the next chars are all
+// digits. Returns the number of chars used, 0 if it cannot.
+template <typename Alphabet>
+size_t completeGroup(const char* input, size_t length, uint8_t*& output, DecodeState& state) {
+    size_t need = 5 - state.count;
+    if (state.count == 0 || length < need) {
+        return 0;
+    }
+    uint32_t value = 0;
+    for (int j = 0; j < state.count; j++) {
+        value = value * 85 + state.digits[j];
+    }
+    for (size_t j = 0; j < need; j++) {
+        uint8_t entry = DECODING_TABLE_OF<Alphabet>[static_cast<unsigned char>(input[j])];
+        if (entry & NOT_DIGIT) {
+            return 0;
+        }
+        value = value * 85 + entry;
+    }
+    for (int j = 0; j < 4; j++) {
+        *output++ = static_cast<uint8_t>(value >> (8 * (3 - j)));
+    }
+    state.count = 0;
+    return need;
+}
+
+// Decodes the digits before `input[at]`, a char that is not one, and steps
+// over that char: whitespace is skipped, a shortcut expands. Returns the
+// number of chars consumed, `at` if the char starts an end marker. Called
+// at a group boundary.
+template <typename Alphabet>
+inline size_t skipNonDigit(const char* input, size_t at, uint8_t*& output, DecodeState& state) {
+    const auto& table = DECODING_TABLE_OF<Alphabet>;
+    auto digit = [&](size_t j) { return table[static_cast<unsigned char>(input[j])]; };
+
+    size_t whole = at - at % 5;
+    for (size_t j = 0; j < whole; j += 5) {
+        uint32_t value = (((digit(j) * 85u + digit(j + 1)) * 85u + digit(j + 2)) * 85u +
+                          digit(j + 3)) * 85u + digit(j + 4);
+        value = __builtin_bswap32(value);
+        std::memcpy(output, &value, 4);
+        output += 4;
+    }
+    state.count = static_cast<int>(at - whole);
+    for (int j = 0; j < state.count; j++) {
+        state.digits[j] = digit(whole + j);
+    }
+
+    uint8_t entry = digit(at);
+    if (entry == (NOT_DIGIT | FRAME_END)) {
+        return at;
+    }
+    if (entry == (NOT_DIGIT | ZERO_GROUP) || entry == (NOT_DIGIT | SPACE_GROUP)) {
+        uint32_t word = entry == (NOT_DIGIT | ZERO_GROUP) ? 0 : 0x20202020u;
+        std::memcpy(output, &word, 4);
+        output += 4;
+        state.shortcuts++;
+    }
+    return at + 1;
+}
+
+// The kernels decode digit runs in place and step over whatever interrupts
+// them (line breaks, shortcuts) without returning, so wrapped text stays in
+// the kernel; only an end marker or the tail is left to the caller
+template <typename Alphabet>
+__attribute__((target("sse4.1")))
+size_t decodeTrustedBlocksSSE41(const char* input, size_t length, uint8_t*& output,
+                                DecodeState& state) {
+    size_t i = 0;
+    while (true) {
+        i += completeGroup<Alphabet>(input + i, length - i, output, state);
+        if (state.count != 0) {
+            return i;
+        }
+
+        unsigned mask = 0;
+        for (; i + 20 <= length; i += 20) {
+            __m128i first = translateSSE41<Alphabet>(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)));
+            __m128i second = translateSSE41<Alphabet>(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 4)));
+            mask = static_cast<unsigned>(_mm_movemask_epi8(nonDigitsSSE41(first))) |
+                   static_cast<unsigned>(_mm_movemask_epi8(nonDigitsSSE41(second))) << 4;
+            if (mask != 0) {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output), groupValuesSSE41(first, second));
+            output += 16;
+        }
+        if (mask == 0) {
+            return i;
+        }
+
+        size_t at = __builtin_ctz(mask);
+        size_t consumed = skipNonDigit<Alphabet>(input + i, at, output, state);
+        i += consumed;
+        if (consumed <= at) {
+            return i;
+        }
+    }
+}
+
+// 16 chars at `input` and 16 at `input + 20` (8 groups, 4 per 128-bit
+// lane), translated to the Adobe alphabet
+template <typename Alphabet>
+__attribute__((target("avx2")))
+inline __m256i loadGroupsAVX2(const char* input) {
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 20));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(translateSSE41<Alphabet>(low)),
+                                   translateSSE41<Alphabet>(high), 1);
+}
+
+template <typename Alphabet>
+__attribute__((target("avx2")))
+size_t decodeTrustedBlocksAVX2(const char* input, size_t length, uint8_t*& output,
+                               DecodeState& state) {
+    size_t i = 0;
+    while (true) {
+        i += completeGroup<Alphabet>(input + i, length - i, output, state);
+        if (state.count != 0) {
+            return i;
+        }
+
+        uint64_t mask = 0;
+        for (; i + 40 <= length; i += 40) {
+            __m256i first = loadGroupsAVX2<Alphabet>(input + i);
+            __m256i second = loadGroupsAVX2<Alphabet>(input + i + 4);
+            uint64_t firstMask = static_cast<uint32_t>(_mm256_movemask_epi8(nonDigitsAVX2(first)));
+            uint64_t secondMask = static_cast<uint32_t>(_mm256_movemask_epi8(nonDigitsAVX2(second)));
+            if ((firstMask | secondMask) != 0) {
+                // Lane bit k stands for char k, upper lane bit k for char 20 + k
+                uint64_t low = (firstMask & 0xFFFF) | (secondMask & 0xFFFF) << 4;
+                uint64_t high = (firstMask >> 16) | (secondMask >> 16) << 4;
+                mask = low | high << 20;
+                break;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), groupValuesAVX2(first, second));
+            output += 32;
+        }
+        if (mask == 0) {
+            // Let the narrower kernel pick up a remaining run of 4 groups
+            return i + decodeTrustedBlocksSSE41<Alphabet>(input + i, length - i, output, state);
+        }
+
+        // A first half of digits still goes through the vector path
+        size_t at = __builtin_ctzll(mask);
+        if (at >= 20) {
+            __m128i first = translateSSE41<Alphabet>(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)));
+            __m128i second = translateSSE41<Alphabet>(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 4)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output), groupValuesSSE41(first, second));
+            output += 16;
+            i += 20;
+            at -= 20;
+        }
+        size_t consumed = skipNonDigit<Alphabet>(input + i, at, output, state);
+        i += consumed;
+        if (consumed <= at) {
+            return i;
+        }
+    }
+}
+
+template <typename Alphabet>
+__attribute__((target("sse4.1")))
+size_t encodeBlocksSSE41(const uint8_t* input, size_t length, char*& output) {
+    const __m128i byteSwap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128i base = _mm_set1_epi32(85);
+    const __m128i spaces = _mm_set1_epi32(0x20202020);
+    alignas(16) uint32_t head[4];
+    alignas(16) uint32_t tail[4];
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i value = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)), byteSwap);
+        unsigned zeroMask = Alphabet::ZERO_CHAR == 0 ? 0 : _mm_movemask_ps(
+            _mm_castsi128_ps(_mm_cmpeq_epi32(value, _mm_setzero_si128())));
+        unsigned spaceMask = Alphabet::SPACE_CHAR == 0 ? 0 : _mm_movemask_ps(
+            _mm_castsi128_ps(_mm_cmpeq_epi32(value, spaces)));
+
+        // Peel off base-85 digits, least significant first
+        __m128i digits[5];
+        for (int j = 4; j > 0; j--) {
+            __m128i quotient = div85SSE41(value);
+            digits[j] = _mm_sub_epi32(value, _mm_mullo_epi32(quotient, base));
+            value = quotient;
+        }
+        digits[0] = value;
+
+        __m128i packed = _mm_or_si128(
+            _mm_or_si128(digits[0], _mm_slli_epi32(digits[1], 8)),
+            _mm_or_si128(_mm_slli_epi32(digits[2], 16), _mm_slli_epi32(digits[3], 24)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(head), digitCharsSSE41<Alphabet>(packed));
+        _mm_store_si128(reinterpret_cast<__m128i*>(tail), digitCharsSSE41<Alphabet>(digits[4]));
+
+        emitGroups<Alphabet>(head, tail, zeroMask, spaceMask, 4, output);
+    }
+
+    return i;
+}
+
+template <typename Alphabet>
+__attribute__((target("avx2")))
+size_t encodeBlocksAVX2(const uint8_t* input, size_t length, char*& output) {
+    const __m256i byteSwap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                              3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i base = _mm256_set1_epi32(85);
+    const __m256i spaces = _mm256_set1_epi32(0x20202020);
+    alignas(32) uint32_t head[8];
+    alignas(32) uint32_t tail[8];
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i value = _mm256_shuffle_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)), byteSwap);
+        unsigned zeroMask = Alphabet::ZERO_CHAR == 0 ? 0 : _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(value, _mm256_setzero_si256())));
+        unsigned spaceMask = Alphabet::SPACE_CHAR == 0 ? 0 : _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(value, spaces)));
+
+        // Peel off base-85 digits, least significant first
+        __m256i digits[5];
+        for (int j = 4; j > 0; j--) {
+            __m256i quotient = div85AVX2(value);
+            digits[j] = _mm256_sub_epi32(value, _mm256_mullo_epi32(quotient, base));
+            value = quotient;
+        }
+        digits[0] = value;
+
+        __m256i packed = _mm256_or_si256(
+            _mm256_or_si256(digits[0], _mm256_slli_epi32(digits[1], 8)),
+            _mm256_or_si256(_mm256_slli_epi32(digits[2], 16), _mm256_slli_epi32(digits[3], 24)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(head), digitCharsAVX2<Alphabet>(packed));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tail),
+                           digitCharsAVX2<Alphabet>(digits[4]));
+
+        emitGroups<Alphabet>(head, tail, zeroMask, spaceMask, 8, output);
+    }
+
+    // Let the narrower kernel pick up a remaining 16-byte block
+    return i + encodeBlocksSSE41<Alphabet>(input + i, length - i, output);
+}
+
+} // namespace
+
+// The kernels are declared without target attributes, which template
+// instantiations would otherwise inherit; they only call into the
+// attributed implementations above
+template <typename Alphabet>
+size_t encodeSSE41(const uint8_t* input, size_t length, char*& output) {
+    return encodeBlocksSSE41<Alphabet>(input, length, output);
+}
+
+template <typename Alphabet>
+size_t encodeAVX2(const uint8_t* input, size_t length, char*& output) {
+    return encodeBlocksAVX2<Alphabet>(input, length, output);
+}
+
+template <typename Alphabet>
+size_t decodeSSE41(const char* input, size_t length, uint8_t*& output, DecodeState& state) {
+    return decodeBlocks<Alphabet, decodeGroupsSSE41>(input, length, output, state);
+}
+
+template <typename Alphabet>
+size_t decodeAVX2(const char* input, size_t length, uint8_t*& output, DecodeState& state) {
+    return decodeBlocks<Alphabet, decodeGroupsAVX2>(input, length, output, state);
+}
+
+template <typename Alphabet>
+size_t decodeTrustedSSE41(const char* input, size_t length, uint8_t*& output,
+                          DecodeState& state) {
+    return decodeTrustedBlocksSSE41<Alphabet>(input, length, output, state);
+}
+
+template <typename Alphabet>
+size_t decodeTrustedAVX2(const char* input, size_t length, uint8_t*& output,
+                         DecodeState& state) {
+    return decodeTrustedBlocksAVX2<Alphabet>(input, length, output, state);
+}
+
+bool hasSSE41() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+}
+
+bool hasAVX2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#else // !ASCII85_X86
+
+// Without x86 intrinsics the vector kernels defer to the scalar path
+template <typename Alphabet>
+size_t encodeSSE41(const uint8_t* input, size_t length, char*& output) {
+    return encodeScalar<Alphabet>(input, length, output);
+}
+
+template <typename Alphabet>
+size_t encodeAVX2(const uint8_t* input, size_t length, char*& output) {
+    return encodeScalar<Alphabet>(input, length, output);
+}
+
+template <typename Alphabet>
+size_t decodeSSE41(const char* input, size_t length, uint8_t*& output, DecodeState& state) {
+    return decodeScalar<Alphabet>(input, length, output, state);
+}
+
+template <typename Alphabet>
+size_t decodeAVX2(const char* input, size_t length, uint8_t*& output, DecodeState& state) {
+    return decodeScalar<Alphabet>(input, length, output, state);
+}
+
+template <typename Alphabet>
+size_t decodeTrustedSSE41(const char* input, size_t length, uint8_t*& output,
+                          DecodeState& state) {
+    return decodeTrustedScalar<Alphabet>(input, length, output, state);
+}
+
+template <typename Alphabet>
+size_t decodeTrustedAVX2(const char* input, size_t length, uint8_t*& output,
+                         DecodeState& state) {
+    return decodeTrustedScalar<Alphabet>(input, length, output, state);
+}
+
+bool hasSSE41() {
+    return false;
+}
+
+bool hasAVX2() {
+    return false;
+}
+
+#endif // ASCII85_X86
+
+template <typename Alphabet>
+EncodeKernel encodeKernel() {
+    static const EncodeKernel kernel = hasAVX2() ? encodeAVX2<Alphabet>
+                                     : hasSSE41() ? encodeSSE41<Alphabet>
+                                     : encodeScalar<Alphabet>;
+    return kernel;
+}
+
+template <typename Alphabet>
+DecodeKernel decodeKernel() {
+    static const DecodeKernel kernel = hasAVX2() ? decodeAVX2<Alphabet>
+                                     : hasSSE41() ? decodeSSE41<Alphabet>
+                                     : decodeScalar<Alphabet>;
+    return kernel;
+}
+
+template <typename Alphabet>
+DecodeKernel decodeTrustedKernel() {
+    static const DecodeKernel kernel = hasAVX2() ? decodeTrustedAVX2<Alphabet>
+                                     : hasSSE41() ? decodeTrustedSSE41<Alphabet>
+                                     : decodeTrustedScalar<Alphabet>;
+    return kernel;
+}
+
+namespace {
+
+// Alternates between a vector kernel and a scalar path: the kernel stops at
+// a block it cannot handle (or the tail), the scalar path gets past it and
+// hands back to the kernel
+size_t decodeWith(DecodeKernel kernel, DecodeKernel scalar, const char* input, size_t length,
+                  uint8_t*& output, DecodeState& state) {
+    size_t i = 0;
+    while (i < length) {
+        i += kernel(input + i, length - i, output, state);
+        size_t step = std::min(length - i, size_t(16));
+        size_t consumed = scalar(input + i, step, output, state);
+        i += consumed;
+        if (consumed < step) {
+            break;
+        }
+    }
+    return i;
+}
+
+} // namespace
+
+template <typename Alphabet>
+size_t decode(const char* input, size_t length, uint8_t*& output, DecodeState& state) {
+    return decodeWith(decodeKernel<Alphabet>(), decodeScalar<Alphabet>, input, length, output,
+                      state);
+}
+
+template <typename Alphabet>
+size_t decodeTrusted(const char* input, size_t length, uint8_t*& output, DecodeState& state) {
+    return decodeWith(decodeTrustedKernel<Alphabet>(), decodeTrustedScalar<Alphabet>, input,
+                      length, output, state);
+}
+
+// The variants the codec is instantiated for
+#define ASCII85_INSTANTIATE_KERNELS(Alphabet)                                                \
+    template size_t encodeScalar<Alphabet>(const uint8_t*, size_t, char*&);                  \
+    template size_t encodeSSE41<Alphabet>(const uint8_t*, size_t, char*&);                   \
+    template size_t encodeAVX2<Alphabet>(const uint8_t*, size_t, char*&);                    \
+    template size_t decodeScalar<Alphabet>(const char*, size_t, uint8_t*&, DecodeState&);    \
+    template void decodeFinish<Alphabet>(DecodeState&, uint8_t*&);                           \
+    template size_t decodeSSE41<Alphabet>(const char*, size_t, uint8_t*&, DecodeState&);     \
+    template size_t decodeAVX2<Alphabet>(const char*, size_t, uint8_t*&, DecodeState&);      \
+    template EncodeKernel encodeKernel<Alphabet>();                                          \
+    template DecodeKernel decodeKernel<Alphabet>();                                          \
+    template size_t decode<Alphabet>(const char*, size_t, uint8_t*&, DecodeState&);          \
+    template size_t decodeTrustedScalar<Alphabet>(const char*, size_t, uint8_t*&,            \
+                                                  DecodeState&);                             \
+    template size_t decodeTrustedSSE41<Alphabet>(const char*, size_t, uint8_t*&,             \
+                                                 DecodeState&);                              \
+    template size_t decodeTrustedAVX2<Alphabet>(const char*, size_t, uint8_t*&, DecodeState&); \
+    template DecodeKernel decodeTrustedKernel<Alphabet>();                                   \
+    template size_t decodeTrusted<Alphabet>(const char*, size_t, uint8_t*&, DecodeState&);
+
+ASCII85_INSTANTIATE_KERNELS(alphabet::Adobe)
+ASCII85_INSTANTIATE_KERNELS(alphabet::Btoa)
+ASCII85_INSTANTIATE_KERNELS(alphabet::Z85)
+ASCII85_INSTANTIATE_KERNELS(alphabet::Rfc1924)
+
+#undef ASCII85_INSTANTIATE_KERNELS
+
+} // namespace simd
+} // namespace ascii85
@@ -0,0 +1,134 @@
+#include "crc32c.hpp"
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRC32C_X86 1
+#include <immintrin.h>
+#else
+#define CRC32C_X86 0
+#endif
+
+namespace ascii85 {
+
+namespace {
+
+// Castagnoli polynomial, bit-reflected (x^0 in the top bit)
+constexpr uint32_t POLY = 0x82F63B78u;
+
+constexpr std::array<uint32_t, 256> makeTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = n;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ POLY : crc >> 1;
+        }
+        table[n] = crc;
+    }
+    return table;
+}
+
+constexpr auto TABLE = makeTable();
+
+// Raw CRC update (no pre- and post-inversion), one table lookup per byte
+uint32_t updateScalar(uint32_t crc, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        crc = TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if CRC32C_X86
+
+// The crc32 instruction takes 8 bytes per step
+__attribute__((target("sse4.2")))
+uint32_t updateSSE42(uint32_t crc, const uint8_t* data, size_t length) {
+    uint64_t wide = crc;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        wide = _mm_crc32_u64(wide, word);
+    }
+    uint32_t narrow = static_cast<uint32_t>(wide);
+    for (; i < length; i++) {
+        narrow = _mm_crc32_u8(narrow, data[i]);
+    }
+    return narrow;
+}
+
+#endif // CRC32C_X86
+
+using Update = uint32_t (*)(uint32_t crc, const uint8_t* data, size_t length);
+
+// Best update for this CPU, selected once by CPUID
+Update selectUpdate() {
+#if CRC32C_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        return updateSSE42;
+    }
+#endif
+    return updateScalar;
+}
+
+// a * b modulo the polynomial
+constexpr uint32_t multModP(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31;
+    uint32_t product = 0;
+    while (true) {
+        if (a & m) {
+            product ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return product;
+}
+
+// x^(2^k) modulo the polynomial
+constexpr std::array<uint32_t, 32> makePowers() {
+    std::array<uint32_t, 32> powers{};
+    powers[0] = 1u << 30; // x^1
+    for (int k = 1; k < 32; k++) {
+        powers[k] = multModP(powers[k - 1], powers[k - 1]);
+    }
+    return powers;
+}
+
+constexpr auto POWERS = makePowers();
+
+// x^(8 * length) modulo the polynomial; multiplying a CRC by it runs the
+// CRC over `length` zero bytes
+uint32_t zeroBytesOperator(size_t length) {
+    uint32_t result = 1u << 31; // x^0
+    for (unsigned k = 3; length != 0; length >>= 1, k++) {
+        if (length & 1) {
+            result = multModP(POWERS[k & 31], result);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+void Crc32c::update(const void* data, size_t length) {
+    static const Update kernel = selectUpdate();
+    crc = ~kernel(~crc, static_cast<const uint8_t*>(data), length);
+}
+
+void Crc32c::append(uint32_t digest, size_t length) {
+    // CRC(A + B) is CRC(A) carried past |B| zero bytes, plus CRC(B)
+    crc = multModP(zeroBytesOperator(length), crc) ^ digest;
+}
+
+uint32_t Crc32c::compute(const void* data, size_t length) {
+    Crc32c checksum;
+    checksum.update(data, length);
+    return checksum.value();
+}
+
+} // namespace ascii85
@@ -1,22 +1,123 @@
 #include "ascii85.hpp"
+#include "raw_file.hpp"
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace ascii85;
 
 void printHelp() {
-    std::cout << "Usage: ascii85 [options]" << std::endl;
+    std::cout << "Usage: ascii85 [options] [FILE...]" << std::endl;
+    std::cout << "With FILEs, encodes each to FILE.a85 (or decodes FILE.a85 to FILE) on --threads workers" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  -e, --encode    Encode data (default)" << std::endl;
     std::cout << "  -d, --decode    Decode data" << std::endl;
     std::cout << "  -b, --buffer    Use buffer mode instead of stream mode" << std::endl;
+    std::cout << "  -m, --mmap      Memory-map input and output files (needs -i and -o)" << std::endl;
+    std::cout << "  -i, --input F   Read from file F instead of STDIN" << std::endl;
+    std::cout << "  -o, --output F  Write to file F instead of STDOUT" << std::endl;
+    std::cout << "  -w, --wrap N    Break encoded lines after N characters (0 = no breaks, default)" << std::endl;
+    std::cout << "  --frame         Enclose encoded output in <~ and ~>" << std::endl;
+    std::cout << "  --alphabet A    Base-85 variant: ascii85 (default), btoa, z85 or rfc1924" << std::endl;
+    std::cout << "  --trusted       Decode without validating (only for input this tool encoded)" << std::endl;
+    std::cout << "  --checksum      Print the CRC32C of the raw (unencoded) data to STDERR" << std::endl;
+    std::cout << "  --stats         Print codec counters and timings to STDERR when done" << std::endl;
+    std::cout << "  --stats-json    Same as --stats, as one line of JSON" << std::endl;
+    std::cout << "  --manifest F    Read FILEs one per line from F (- = STDIN)" << std::endl;
+    std::cout << "  --block-size N  Stream mode read block size, K/M/G suffixes allowed (default 64K)" << std::endl;
+    std::cout << "  --threads N     Worker threads for buffer, mmap, pipeline and FILE modes (0 = all cores, default 1)" << std::endl;
+    std::cout << "  --pipeline-depth N  Stream mode with separate reader, codec and writer threads and N blocks in flight" << std::endl;
     std::cout << "  -h, --help      Show this help message" << std::endl;
 }
 
+// Parses a byte count with an optional K/M/G (binary) suffix, 0 on error
+size_t parseSize(const char* text) {
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    if (end == text) {
+        return 0;
+    }
+    
+    switch (*end) {
+        case '\0':
+            return value;
+        case 'k': case 'K':
+            value <<= 10;
+            break;
+        case 'm': case 'M':
+            value <<= 20;
+            break;
+        case 'g': case 'G':
+            value <<= 30;
+            break;
+        default:
+            return 0;
+    }
+    return end[1] == '\0' ? value : 0;
+}
+
+// Parses a line width into `width`, reporting malformed values
+bool parseWidth(const char* text, size_t& width) {
+    char* end = nullptr;
+    width = std::strtoul(text, &end, 10);
+    if (end == text || *end != '\0') {
+        std::cerr << "Invalid line width: " << text << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Appends the non-empty lines of a manifest ("-" = STDIN) to `files`
+void readManifest(const std::string& path, std::vector<std::string>& files) {
+    RawFile manifest = path == "-" ? RawFile::borrow(STDIN_FILENO, "standard input")
+                                   : RawFile::openRead(path);
+    std::string text = manifest.readAll();
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        size_t lineEnd = end > start && text[end - 1] == '\r' ? end - 1 : end;
+        if (lineEnd > start) {
+            files.push_back(text.substr(start, lineEnd - start));
+        }
+        start = end + 1;
+    }
+}
+
+// True when both paths name one existing file, through links or not
+bool sameFile(const std::string& first, const std::string& second) {
+    struct stat a;
+    struct stat b;
+    return ::stat(first.c_str(), &a) == 0 && ::stat(second.c_str(), &b) == 0 &&
+           a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+}
+
 int main(int argc, char* argv[]) {
-    ASCII85::Mode mode = ASCII85::Mode::STREAM;
+    // iostreams only carry messages; keep them off the C stdio locks
+    std::ios::sync_with_stdio(false);
+    
+    Mode mode = Mode::STREAM;
     bool decode = false;
+    size_t blockSize = ASCII85::DEFAULT_BLOCK_SIZE;
+    size_t threads = 1;
+    size_t pipelineDepth = 0;
+    bool useMmap = false;
+    bool printChecksum = false;
+    bool printStats = false;
+    bool statsAsJson = false;
+    EncodeOptions options;
+    std::string alphabetName = alphabet::Adobe::NAME;
+    std::string inputFile;
+    std::string outputFile;
+    std::string manifestFile;
+    std::vector<std::string> files;
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -34,7 +135,52 @@ int main(int argc, char* argv[]) {
                 } else if (strcmp(arg, "--decode") == 0) {
                     decode = true;
                 } else if (strcmp(arg, "--buffer") == 0) {
-                    mode = ASCII85::Mode::BUFFER;
+                    mode = Mode::BUFFER;
+                } else if (strcmp(arg, "--mmap") == 0) {
+                    useMmap = true;
+                } else if (strcmp(arg, "--frame") == 0) {
+                    options.frame = true;
+                } else if (strcmp(arg, "--wrap") == 0 && i + 1 < argc) {
+                    if (!parseWidth(argv[++i], options.lineWidth)) {
+                        return 1;
+                    }
+                } else if (strcmp(arg, "--trusted") == 0) {
+                    options.trusted = true;
+                } else if (strcmp(arg, "--checksum") == 0) {
+                    printChecksum = true;
+                } else if (strcmp(arg, "--stats") == 0) {
+                    printStats = true;
+                } else if (strcmp(arg, "--stats-json") == 0) {
+                    printStats = true;
+                    statsAsJson = true;
+                } else if (strcmp(arg, "--alphabet") == 0 && i + 1 < argc) {
+                    alphabetName = argv[++i];
+                } else if (strcmp(arg, "--input") == 0 && i + 1 < argc) {
+                    inputFile = argv[++i];
+                } else if (strcmp(arg, "--output") == 0 && i + 1 < argc) {
+                    outputFile = argv[++i];
+                } else if (strcmp(arg, "--manifest") == 0 && i + 1 < argc) {
+                    manifestFile = argv[++i];
+                } else if (strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+                    char* end = nullptr;
+                    threads = std::strtoul(argv[++i], &end, 10);
+                    if (end == argv[i] || *end != '\0') {
+                        std::cerr << "Invalid thread count: " << argv[i] << std::endl;
+                        return 1;
+                    }
+                } else if (strcmp(arg, "--pipeline-depth") == 0 && i + 1 < argc) {
+                    char* end = nullptr;
+                    pipelineDepth = std::strtoul(argv[++i], &end, 10);
+                    if (end == argv[i] || *end != '\0' || pipelineDepth == 0) {
+                        std::cerr << "Invalid pipeline depth: " << argv[i] << std::endl;
+                        return 1;
+                    }
+                } else if (strcmp(arg, "--block-size") == 0 && i + 1 < argc) {
+                    blockSize = parseSize(argv[++i]);
+                    if (blockSize == 0) {
+                        std::cerr << "Invalid block size: " << argv[i] << std::endl;
+                        return 1;
+                    }
                 } else {
                     std::cerr << "Unknown option: " << arg << std::endl;
                     return 1;
@@ -42,8 +188,10 @@ int main(int argc, char* argv[]) {
             }
             // Short option
             else {
+                // -i, -o and -w take the next argument and must end their group
+                bool takesValue = false;
                 
-                for (int j = 1; arg[j] != '\0'; ++j) {
+                for (int j = 1; arg[j] != '\0' && !takesValue; ++j) {
                     switch (arg[j]) {
                         case 'h':
                             printHelp();
@@ -55,7 +203,29 @@ int main(int argc, char* argv[]) {
                             decode = true;
                             break;
                         case 'b':
-                            mode = ASCII85::Mode::BUFFER;
+                            mode = Mode::BUFFER;
+                            break;
+                        case 'm':
+                            useMmap = true;
+                            break;
+                        case 'i':
+                        case 'o':
+                            if (arg[j + 1] != '\0' || i + 1 >= argc) {
+                                std::cerr << "Option -" << arg[j] << " requires a file name" << std::endl;
+                                return 1;
+                            }
+                            (arg[j] == 'i' ? inputFile : outputFile) = argv[++i];
+                            takesValue = true;
+                            break;
+                        case 'w':
+                            if (arg[j + 1] != '\0' || i + 1 >= argc) {
+                                std::cerr << "Option -w requires a line width" << std::endl;
+                                return 1;
+                            }
+                            if (!parseWidth(argv[++i], options.lineWidth)) {
+                                return 1;
+                            }
+                            takesValue = true;
                             break;
                         default:
                             std::cerr << "Unknown option: -" << arg[j] << std::endl;
@@ -64,17 +234,107 @@ int main(int argc, char* argv[]) {
                 }
             }
         } else {
-            std::cerr << "Unknown argument: " << arg << std::endl;
-            return 1;
+            files.push_back(arg);
         }
     }
     
+    bool batch = !files.empty() || !manifestFile.empty();
+    if (batch && (useMmap || !inputFile.empty() || !outputFile.empty())) {
+        std::cerr << "FILE arguments and --manifest cannot be combined with -m, -i or -o" << std::endl;
+        return 1;
+    }
+    
+    if (batch && printChecksum) {
+        std::cerr << "--checksum is not supported with FILE arguments or --manifest" << std::endl;
+        return 1;
+    }
+    
+    if (pipelineDepth != 0 && (batch || useMmap || mode != Mode::STREAM)) {
+        std::cerr << "--pipeline-depth applies to stream mode only" << std::endl;
+        return 1;
+    }
+    
+    if (useMmap && (inputFile.empty() || outputFile.empty())) {
+        std::cerr << "Memory-mapped mode needs both -i and -o" << std::endl;
+        return 1;
+    }
+    
+    // Creating the output truncates it, which would destroy the input first
+    if (!inputFile.empty() && !outputFile.empty() && sameFile(inputFile, outputFile)) {
+        std::cerr << "Input and output are the same file: " << inputFile << std::endl;
+        return 1;
+    }
+    
+    // Everything below is the same for every variant, only the codec differs
+    Stats stats;
+    Stats* counters = printStats ? &stats : nullptr;
+    auto report = [&] {
+        if (printStats) {
+            std::cerr << (statsAsJson ? stats.toJson() + '\n' : stats.format()) << std::flush;
+        }
+    };
+    
+    auto run = [&](auto codec) {
+        using Codec = decltype(codec);
+        
+        if (batch) {
+            if (!manifestFile.empty()) {
+                readManifest(manifestFile, files);
+            }
+            std::vector<std::string> errors =
+                Codec::processFiles(files, decode, threads, blockSize, options, counters);
+            for (const auto& error : errors) {
+                std::cerr << "Error: " << error << '\n';
+            }
+            report();
+            return errors.empty() ? 0 : 1;
+        }
+        
+        // The digest is always of the raw data: the input when encoding,
+        // the output when decoding
+        Crc32c checksum;
+        Crc32c* sum = printChecksum ? &checksum : nullptr;
+        
+        if (useMmap) {
+            Codec::processFile(inputFile, outputFile, decode, threads, options, sum, counters);
+        } else {
+            // Data goes through read(2)/write(2) on the descriptors, never iostreams
+            RawFile input = inputFile.empty() ? RawFile::borrow(STDIN_FILENO, "standard input")
+                                              : RawFile::openRead(inputFile);
+            RawFile output = outputFile.empty() ? RawFile::borrow(STDOUT_FILENO, "standard output")
+                                                : RawFile::create(outputFile);
+            if (pipelineDepth != 0) {
+                Codec::processPipeline(input.descriptor(), output.descriptor(), decode, blockSize,
+                                       threads, pipelineDepth, options, sum, counters);
+            } else {
+                Codec::process(input.descriptor(), output.descriptor(), mode, decode, blockSize,
+                               threads, options, sum, counters);
+            }
+        }
+        
+        if (printChecksum) {
+            char digest[16];
+            std::snprintf(digest, sizeof(digest), "%08x", checksum.value());
+            std::cerr << "CRC32C: " << digest << std::endl;
+        }
+        report();
+        return 0;
+    };
+    
     try {
-        ASCII85::process(std::cin, std::cout, mode, decode);
+        if (alphabetName == alphabet::Adobe::NAME) {
+            return run(ASCII85());
+        } else if (alphabetName == alphabet::Btoa::NAME) {
+            return run(Btoa());
+        } else if (alphabetName == alphabet::Z85::NAME) {
+            return run(Z85());
+        } else if (alphabetName == alphabet::Rfc1924::NAME) {
+            return run(RFC1924());
+        }
+        std::cerr << "Unknown alphabet: " << alphabetName << std::endl;
+        return 1;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
-    
-    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "mapped_file.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ascii85 {
+
+namespace {
+
+std::runtime_error fileError(const std::string& what, const std::string& path) {
+    int error = errno;
+    return std::runtime_error(what + " " + path + ": " + std::strerror(error));
+}
+
+} // namespace
+
+MappedFile MappedFile::openRead(const std::string& path) {
+    MappedFile file;
+    file.fd = ::open(path.c_str(), O_RDONLY);
+    if (file.fd < 0) {
+        throw fileError("Could not open file", path);
+    }
+
+    struct stat info;
+    if (::fstat(file.fd, &info) != 0) {
+        throw fileError("Could not stat file", path);
+    }
+    file.length = static_cast<size_t>(info.st_size);
+
+    // mmap() rejects empty mappings, an empty file simply has no data
+    if (file.length > 0) {
+        void* mapping = ::mmap(nullptr, file.length, PROT_READ, MAP_PRIVATE, file.fd, 0);
+        if (mapping == MAP_FAILED) {
+            throw fileError("Could not map file", path);
+        }
+        file.mapping = static_cast<uint8_t*>(mapping);
+        ::madvise(mapping, file.length, MADV_SEQUENTIAL);
+    }
+
+    return file;
+}
+
+MappedFile MappedFile::create(const std::string& path, size_t size) {
+    MappedFile file;
+    file.writable = true;
+    file.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file.fd < 0) {
+        throw fileError("Could not create file", path);
+    }
+
+    // Sized up front; the unwritten tail stays sparse until it is cut off
+    if (::ftruncate(file.fd, static_cast<off_t>(size)) != 0) {
+        throw fileError("Could not resize file", path);
+    }
+    file.length = size;
+
+    if (file.length > 0) {
+        void* mapping = ::mmap(nullptr, file.length, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+        if (mapping == MAP_FAILED) {
+            throw fileError("Could not map file", path);
+        }
+        file.mapping = static_cast<uint8_t*>(mapping);
+        ::madvise(mapping, file.length, MADV_SEQUENTIAL);
+    }
+
+    return file;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd = std::exchange(other.fd, -1);
+        mapping = std::exchange(other.mapping, nullptr);
+        length = std::exchange(other.length, 0);
+        finalSize = std::exchange(other.finalSize, 0);
+        writable = std::exchange(other.writable, false);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::release(size_t offset, size_t size) {
+    // madvise() needs a page-aligned start. Rounding outwards is safe: the
+    // input is never modified and shared pages keep their data in the cache.
+    const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t begin = offset / pageSize * pageSize;
+    size_t end = std::min(offset + size, length);
+    if (mapping != nullptr && begin < end) {
+        ::madvise(mapping + begin, end - begin, MADV_DONTNEED);
+    }
+}
+
+void MappedFile::close() {
+    if (mapping != nullptr) {
+        ::munmap(mapping, length);
+        mapping = nullptr;
+    }
+    if (fd >= 0) {
+        if (writable) {
+            // Nothing to report from a destructor; a failed truncate leaves
+            // zero padding at the end of the file
+            (void)::ftruncate(fd, static_cast<off_t>(finalSize));
+        }
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+} // namespace ascii85
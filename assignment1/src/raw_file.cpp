@@ -0,0 +1,144 @@
+#include "raw_file.hpp"
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ascii85 {
+
+namespace {
+
+std::runtime_error fileError(const std::string& what, const std::string& name) {
+    int error = errno;
+    return std::runtime_error(what + " " + name + ": " + std::strerror(error));
+}
+
+size_t pageSize() {
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+} // namespace
+
+AlignedBuffer::AlignedBuffer(size_t size) : length(size) {
+    void* pointer = nullptr;
+    if (::posix_memalign(&pointer, pageSize(), size > 0 ? size : 1) != 0) {
+        throw std::bad_alloc();
+    }
+    buffer.reset(static_cast<char*>(pointer));
+}
+
+RawFile RawFile::openRead(const std::string& path) {
+    RawFile file;
+    file.name = path;
+    file.owned = true;
+    file.fd = ::open(path.c_str(), O_RDONLY);
+    if (file.fd < 0) {
+        throw fileError("Could not open file", path);
+    }
+    return file;
+}
+
+RawFile RawFile::create(const std::string& path) {
+    RawFile file;
+    file.name = path;
+    file.owned = true;
+    file.fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file.fd < 0) {
+        throw fileError("Could not create file", path);
+    }
+    return file;
+}
+
+RawFile RawFile::borrow(int fd, const std::string& name) {
+    RawFile file;
+    file.fd = fd;
+    file.name = name;
+    return file;
+}
+
+RawFile::RawFile(RawFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+RawFile& RawFile::operator=(RawFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd = std::exchange(other.fd, -1);
+        owned = std::exchange(other.owned, false);
+        name = std::move(other.name);
+    }
+    return *this;
+}
+
+RawFile::~RawFile() {
+    close();
+}
+
+bool RawFile::isTerminal() const {
+    return ::isatty(fd) == 1;
+}
+
+size_t RawFile::read(char* buffer, size_t size) {
+    while (true) {
+        ssize_t count = ::read(fd, buffer, size);
+        if (count >= 0) {
+            return static_cast<size_t>(count);
+        }
+        if (errno != EINTR) {
+            throw fileError("Could not read", name);
+        }
+    }
+}
+
+std::string RawFile::readAll() {
+    // Regular files say how much there is; anything else grows as it comes
+    struct stat info;
+    size_t capacity = 1 << 20;
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        capacity = static_cast<size_t>(info.st_size) + 1;
+    }
+
+    std::string data(capacity, '\0');
+    size_t length = 0;
+    while (true) {
+        if (length == data.size()) {
+            data.resize(data.size() * 2);
+        }
+        size_t count = read(&data[length], data.size() - length);
+        if (count == 0) {
+            break;
+        }
+        length += count;
+    }
+    data.resize(length);
+    return data;
+}
+
+void RawFile::write(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t count = ::write(fd, data, size);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw fileError("Could not write", name);
+        }
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+}
+
+void RawFile::close() {
+    if (owned && fd >= 0) {
+        ::close(fd);
+    }
+    fd = -1;
+    owned = false;
+}
+
+} // namespace ascii85
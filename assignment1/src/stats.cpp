@@ -0,0 +1,86 @@
+#include "stats.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace ascii85 {
+
+namespace {
+
+// Chars of `bytes` bytes encoded without shortcuts (a partial group of n
+// bytes takes n + 1 chars)
+uint64_t digitsOf(uint64_t bytes) {
+    return bytes / 4 * 5 + (bytes % 4 ? bytes % 4 + 1 : 0);
+}
+
+std::string formatNanos(uint64_t nanos) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(3) << nanos / 1e6 << " ms";
+    return text.str();
+}
+
+} // namespace
+
+void Stats::addEncoded(uint64_t bytes, uint64_t chars, uint64_t lineBreaks, bool frame) {
+    // Every shortcut is 4 chars fewer than the digits of its group
+    uint64_t other = lineBreaks + (frame ? 4 : 0);
+    uint64_t used = chars > other ? chars - other : 0;
+    uint64_t digits = digitsOf(bytes);
+    add(bytesIn, bytes);
+    add(bytesOut, chars);
+    add(groups, (bytes + 3) / 4);
+    add(shortcutGroups, digits > used ? (digits - used) / 4 : 0);
+    add(whitespace, lineBreaks);
+}
+
+void Stats::addDecoded(uint64_t chars, uint64_t bytes, uint64_t shortcuts) {
+    // Unvalidated (trusted) input can hold stray shortcuts, so clamp
+    shortcuts = std::min(shortcuts, bytes / 4);
+    uint64_t used = digitsOf(bytes) - 4 * shortcuts;
+    add(bytesIn, chars);
+    add(bytesOut, bytes);
+    add(groups, (bytes + 3) / 4);
+    add(shortcutGroups, shortcuts);
+    add(whitespace, chars > used ? chars - used : 0);
+}
+
+void Stats::noteBuffer(uint64_t size) {
+    uint64_t peak = peakBuffer.load(std::memory_order_relaxed);
+    while (size > peak &&
+           !peakBuffer.compare_exchange_weak(peak, size, std::memory_order_relaxed)) {
+    }
+}
+
+std::string Stats::format() const {
+    uint64_t codec = codecNanos.load(std::memory_order_relaxed);
+    uint64_t in = bytesIn.load(std::memory_order_relaxed);
+    std::ostringstream text;
+    text << "Bytes in:        " << in << '\n'
+         << "Bytes out:       " << bytesOut.load(std::memory_order_relaxed) << '\n'
+         << "Groups:          " << groups.load(std::memory_order_relaxed) << " ("
+         << shortcutGroups.load(std::memory_order_relaxed) << " shortcuts)" << '\n'
+         << "Whitespace:      " << whitespace.load(std::memory_order_relaxed) << '\n'
+         << "Codec time:      " << formatNanos(codec);
+    if (codec != 0) {
+        text << " (" << std::fixed << std::setprecision(1) << in * 1e3 / codec << " MB/s)";
+    }
+    text << '\n'
+         << "I/O time:        " << formatNanos(ioNanos.load(std::memory_order_relaxed)) << '\n'
+         << "Peak buffer:     " << peakBuffer.load(std::memory_order_relaxed) << " bytes\n";
+    return text.str();
+}
+
+std::string Stats::toJson() const {
+    std::ostringstream text;
+    text << "{\"bytes_in\":" << bytesIn.load(std::memory_order_relaxed)
+         << ",\"bytes_out\":" << bytesOut.load(std::memory_order_relaxed)
+         << ",\"groups\":" << groups.load(std::memory_order_relaxed)
+         << ",\"shortcut_groups\":" << shortcutGroups.load(std::memory_order_relaxed)
+         << ",\"whitespace\":" << whitespace.load(std::memory_order_relaxed)
+         << ",\"codec_ns\":" << codecNanos.load(std::memory_order_relaxed)
+         << ",\"io_ns\":" << ioNanos.load(std::memory_order_relaxed)
+         << ",\"peak_buffer\":" << peakBuffer.load(std::memory_order_relaxed) << "}";
+    return text.str();
+}
+
+} // namespace ascii85
@@ -0,0 +1,88 @@
+#include "thread_pool.hpp"
+#include <exception>
+
+namespace ascii85 {
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = defaultThreadCount();
+    }
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+    std::vector<std::exception_ptr> errors(count);
+    std::mutex doneMutex;
+    std::condition_variable allDone;
+    size_t remaining = count;
+
+    for (size_t i = 0; i < count; i++) {
+        submit([&, i] {
+            try {
+                task(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0) {
+                allDone.notify_one();
+            }
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        allDone.wait(lock, [&] { return remaining == 0; });
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    size_t threads = std::thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+} // namespace ascii85
@@ -58,6 +58,27 @@ else
     exit 1
 fi
 
-python ../tests/random_test.py
+# Test that a file is never both input and output
+echo -e "\nTesting same input and output file"
+cp random_binary same_file
+./ascii85 -i same_file -o same_file 2>/dev/null
+STREAM_STATUS=$?
+./ascii85 -m -i same_file -o ./same_file 2>/dev/null
+MMAP_STATUS=$?
+if [ $STREAM_STATUS -ne 0 ] && [ $MMAP_STATUS -ne 0 ] && cmp -s random_binary same_file; then
+    echo "✅ Test passed: Same input and output file rejected"
+else
+    echo "❌ Test failed: Same input and output file not rejected"
+    exit 1
+fi
+
+# Property tests: every codec path against the reference codec
+echo -e "\nRunning differential property tests"
+if ./ascii85_property_test; then
+    echo "✅ Test passed: All codec paths agree with the reference codec"
+else
+    echo "❌ Test failed: Codec paths disagree"
+    exit 1
+fi
 
 exit 0 
\ No newline at end of file
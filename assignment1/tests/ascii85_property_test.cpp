@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "differential.hpp"
+#include <random>
+#include <string>
+
+using namespace ascii85;
+using differential::checkAll;
+
+namespace {
+
+// Data biased towards what the codec treats specially: zero and space
+// groups (shortcuts), runs of them across kernel block boundaries, and
+// all-0xFF groups (the largest digits)
+std::string randomData(std::mt19937_64& gen, size_t size) {
+    std::string data(size, '\0');
+    uint64_t style = gen() % 4;
+    for (size_t i = 0; i < size; i++) {
+        uint64_t r = gen();
+        if (style == 0 || r % 8 > 2) {
+            data[i] = static_cast<char>(r >> 8);
+        } else {
+            data[i] = r % 8 == 0 ? '\0' : r % 8 == 1 ? ' ' : '\xFF';
+        }
+    }
+    if (style == 3) {
+        // Whole groups of one kind
+        for (size_t i = 0; i + 4 <= size; i += 4) {
+            char fill = "\0 \xFF"[gen() % 3];
+            if (gen() % 2 == 0) {
+                data.replace(i, 4, 4, fill);
+            }
+        }
+    }
+    return data;
+}
+
+// Damages encoded text the ways real input goes wrong: stray and invalid
+// chars, shortcuts inside groups, broken or doubled delimiters, overflowing
+// groups, whitespace anywhere, cut-off ends
+std::string mutate(std::mt19937_64& gen, std::string text) {
+    const std::string inserts[] = {"\n", " \t", "z", "y", "~", "~>", "<~", "{", "\x80", "uuuuu",
+                                   "s8W-\"", "~x", "\r\n", "5", std::string(1, '\0')};
+    size_t edits = gen() % 4 + 1;
+    for (size_t e = 0; e < edits; e++) {
+        size_t at = text.empty() ? 0 : gen() % (text.size() + 1);
+        switch (gen() % 4) {
+            case 0:
+                text.insert(at, inserts[gen() % (sizeof(inserts) / sizeof(*inserts))]);
+                break;
+            case 1:
+                if (at < text.size()) {
+                    text[at] = static_cast<char>(gen());
+                }
+                break;
+            case 2:
+                text.resize(at);
+                break;
+            default:
+                if (at < text.size()) {
+                    text.erase(at, gen() % 6 + 1);
+                }
+                break;
+        }
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(ASCII85PropertyTest, EverySmallSize) {
+    std::mt19937_64 gen(19);
+    for (size_t size = 0; size <= 300; size++) {
+        std::string data = randomData(gen, size);
+        std::string failure = checkAll(data, gen());
+        ASSERT_EQ(failure, "");
+    }
+}
+
+TEST(ASCII85PropertyTest, RandomSizes) {
+    std::mt19937_64 gen(1924);
+    for (int round = 0; round < 60; round++) {
+        std::string data = randomData(gen, gen() % 70000);
+        std::string failure = checkAll(data, gen());
+        ASSERT_EQ(failure, "");
+    }
+}
+
+// Above MIN_PARALLEL_SIZE, so the parallel paths split the work
+TEST(ASCII85PropertyTest, ParallelSizes) {
+    std::mt19937_64 gen(85);
+    for (size_t extra : {size_t(0), size_t(4093)}) {
+        std::string data = randomData(gen, ASCII85::MIN_PARALLEL_SIZE + extra);
+        std::string failure = checkAll(data, gen());
+        ASSERT_EQ(failure, "");
+    }
+
+    // Whitespace after a partial final group leaves the last chunks
+    // without digits
+    std::string data = randomData(gen, ASCII85::MIN_PARALLEL_SIZE + 3);
+    std::string text = ASCII85::encode(data);
+    text.append(text.size() / 2, ' ');
+    std::string failure = differential::checkDecode<alphabet::Adobe>(text, gen());
+    ASSERT_EQ(failure, "");
+}
+
+TEST(ASCII85PropertyTest, EncodedTextRoundTrips) {
+    std::mt19937_64 gen(4);
+    for (int round = 0; round < 200; round++) {
+        std::string data = randomData(gen, gen() % 2000);
+        EncodeOptions options;
+        options.frame = gen() % 2 == 0;
+        options.lineWidth = gen() % 3 == 0 ? 0 : gen() % 80 + 1;
+        std::string text = ASCII85::encode(data, options);
+        std::string failure = differential::checkDecode<alphabet::Adobe>(text, gen());
+        ASSERT_EQ(failure, "");
+    }
+}
+
+TEST(ASCII85PropertyTest, MalformedTextFailsAlike) {
+    std::mt19937_64 gen(85);
+    for (int round = 0; round < 2000; round++) {
+        std::string data = randomData(gen, gen() % 400);
+        EncodeOptions options;
+        options.frame = gen() % 2 == 0;
+        options.lineWidth = gen() % 2 == 0 ? 0 : gen() % 40 + 1;
+        std::string text = mutate(gen, ASCII85::encode(data, options));
+        std::string failure = differential::checkDecode<alphabet::Adobe>(text, gen());
+        ASSERT_EQ(failure, "");
+        failure = differential::checkDecode<alphabet::Btoa>(mutate(gen, Btoa::encode(data)),
+                                                            gen());
+        ASSERT_EQ(failure, "");
+    }
+}
+
+TEST(ASCII85PropertyTest, MalformedTextAboveParallelSize) {
+    std::mt19937_64 gen(1);
+    for (int round = 0; round < 4; round++) {
+        std::string data = randomData(gen, ASCII85::MIN_PARALLEL_SIZE);
+        EncodeOptions options;
+        options.lineWidth = 76;
+        std::string text = mutate(gen, ASCII85::encode(data, options));
+        std::string failure = differential::checkDecode<alphabet::Adobe>(text, gen());
+        ASSERT_EQ(failure, "");
+    }
+}
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include "ascii85.hpp"
+#include "ascii85_simd.hpp"
+#include "raw_file.hpp"
+#include <algorithm>
 #include <sstream>
+#include <fstream>
+#include <random>
+#include <cstdio>
 
 using namespace ascii85;
 
@@ -113,4 +119,1006 @@ TEST(ASCII85Test, BufferMode) {
     ASCII85::process(in2, out2, ASCII85::Mode::BUFFER, true);
     
     EXPECT_EQ(out2.str(), input);
-} 
\ No newline at end of file
+}
+
+TEST(ASCII85Test, EncodedSizeBound) {
+    EXPECT_EQ(ASCII85::encodedSizeBound(0), 0);
+    EXPECT_EQ(ASCII85::encodedSizeBound(1), 2);
+    EXPECT_EQ(ASCII85::encodedSizeBound(4), 5);
+    EXPECT_EQ(ASCII85::encodedSizeBound(13), 17);
+}
+
+TEST(ASCII85Test, EncodeIntoBuffer) {
+    std::string input = "Hello, World!";
+    std::vector<char> output(ASCII85::encodedSizeBound(input.size()));
+    
+    size_t written = ASCII85::encode(reinterpret_cast<const uint8_t*>(input.data()),
+                                     input.size(), output.data());
+    
+    EXPECT_EQ(std::string(output.data(), written), ASCII85::encode(input));
+    
+    // Zero groups collapse to 'z', so the bound is not always reached
+    std::string zeros(8, '\0');
+    written = ASCII85::encode(reinterpret_cast<const uint8_t*>(zeros.data()),
+                              zeros.size(), output.data());
+    EXPECT_EQ(std::string(output.data(), written), "zz");
+}
+
+// Vector kernels must produce exactly what the scalar reference produces
+TEST(ASCII85Test, SimdEncodeMatchesScalar) {
+    std::mt19937 gen(85);
+    std::vector<std::pair<simd::EncodeKernel, bool>> kernels = {
+        {simd::encodeSSE41, simd::hasSSE41()},
+        {simd::encodeAVX2, simd::hasAVX2()},
+    };
+    
+    for (size_t size = 0; size < 300; size += 7) {
+        std::vector<uint8_t> input(size);
+        for (auto& byte : input) {
+            byte = static_cast<uint8_t>(gen());
+        }
+        // Sprinkle zero groups so the 'z' shortcut is exercised inside blocks
+        for (size_t i = 0; i + 4 <= size; i += 12) {
+            std::fill_n(input.begin() + i, 4, 0);
+        }
+        
+        std::vector<char> expected(ASCII85::encodedSizeBound(size));
+        char* end = expected.data();
+        simd::encodeScalar(input.data(), size, end);
+        std::string reference(expected.data(), end);
+        
+        for (const auto& [kernel, supported] : kernels) {
+            if (!supported) {
+                continue;
+            }
+            std::vector<char> output(ASCII85::encodedSizeBound(size));
+            char* out = output.data();
+            size_t consumed = kernel(input.data(), size, out);
+            simd::encodeScalar(input.data() + consumed, size - consumed, out);
+            EXPECT_EQ(std::string(output.data(), out), reference) << "size " << size;
+        }
+    }
+}
+
+TEST(ASCII85Test, DecodeZeroGroupNextToGroup) {
+    std::string input("abcd\0\0\0\0abcd", 12);
+    std::string encoded = ASCII85::encode(input);
+    EXPECT_EQ(encoded, "@:E_Wz@:E_W");
+    EXPECT_EQ(ASCII85::decode(encoded), input);
+}
+
+TEST(ASCII85Test, DecodeIgnoresWhitespace) {
+    EXPECT_EQ(ASCII85::decode(" 6:4\n.0 \t63\r\n"), "BCDEB");
+}
+
+TEST(ASCII85Test, DecodeOverflow) {
+    EXPECT_THROW(ASCII85::decode("s8W-\""), std::runtime_error);
+    EXPECT_EQ(ASCII85::decode("s8W-!"), std::string(4, '\xff'));
+    // Padding a partial group with 'u' must not overflow either
+    EXPECT_THROW(ASCII85::decode("uu"), std::runtime_error);
+}
+
+TEST(ASCII85Test, DecodingTableClasses) {
+    static_assert(ASCII85::DECODING_TABLE['!'] == 0, "first digit");
+    static_assert(ASCII85::DECODING_TABLE['u'] == 84, "last digit");
+    static_assert(ASCII85::DECODING_TABLE['z'] == (NOT_DIGIT | ZERO_GROUP), "zero group");
+    static_assert(ASCII85::DECODING_TABLE[' '] == (NOT_DIGIT | WHITESPACE), "whitespace");
+    static_assert(ASCII85::DECODING_TABLE['v'] == (NOT_DIGIT | INVALID), "invalid");
+    for (int c = 0; c < 256; c++) {
+        EXPECT_EQ(ASCII85::DECODING_TABLE[c] < 85, c >= '!' && c <= 'u') << c;
+    }
+}
+
+TEST(ASCII85Test, DecodeErrorsAcrossScalarBlocks) {
+    // Errors are detected per block, but data before a bad block is kept
+    // out of the result and the right error is reported wherever it sits
+    std::string valid = ASCII85::encode(std::string(1000, 'x'));
+    for (size_t pos : {0u, 255u, 256u, 700u}) {
+        std::string input = valid;
+        input.insert(pos, "v");
+        std::vector<uint8_t> buffer(ASCII85::decodedSizeBound(input.size()));
+        uint8_t* out = buffer.data();
+        simd::DecodeState state;
+        try {
+            simd::decodeScalar(input.data(), input.size(), out, state);
+            FAIL() << "no error at " << pos;
+        } catch (const std::runtime_error& e) {
+            EXPECT_STREQ(e.what(), "Invalid ASCII85 input: character out of range");
+        }
+        EXPECT_LE(static_cast<size_t>(out - buffer.data()), pos / 256 * 256);
+    }
+
+    // With several errors in one block, the first one in the input wins
+    try {
+        Btoa::decode("u!uy!u!z~");
+        FAIL() << "no error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_STREQ(e.what(), "Invalid ASCII85 input: 'y' character in wrong context");
+    }
+}
+
+TEST(ASCII85Test, DecodeIncompleteGroup) {
+    EXPECT_THROW(ASCII85::decode("6:4.06"), std::runtime_error);
+}
+
+// Vector decoder kernels must agree with the scalar reference, including
+// on which inputs they reject
+TEST(ASCII85Test, SimdDecodeMatchesScalar) {
+    std::mt19937 gen(58);
+    std::vector<std::pair<simd::DecodeKernel, bool>> kernels = {
+        {simd::decodeSSE41, simd::hasSSE41()},
+        {simd::decodeAVX2, simd::hasAVX2()},
+    };
+    
+    auto decodeWith = [](simd::DecodeKernel kernel, const std::string& input, std::string& result) {
+        std::vector<uint8_t> output(ASCII85::decodedSizeBound(input.size()) + 4);
+        uint8_t* out = output.data();
+        simd::DecodeState state;
+        try {
+            size_t i = 0;
+            while (i < input.size()) {
+                i += kernel(input.data() + i, input.size() - i, out, state);
+                size_t step = std::min(input.size() - i, size_t(16));
+                if (simd::decodeScalar(input.data() + i, step, out, state) < step) {
+                    return false; // stopped at a '~'
+                }
+                i += step;
+            }
+            simd::decodeFinish(state, out);
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        result.assign(reinterpret_cast<const char*>(output.data()), out - output.data());
+        return true;
+    };
+    
+    for (int round = 0; round < 200; round++) {
+        std::string binary(gen() % 600, '\0');
+        for (auto& byte : binary) {
+            byte = static_cast<char>(gen() % 4 ? gen() : 0);
+        }
+        std::string text = ASCII85::encode(binary);
+        
+        // Wrap lines and occasionally corrupt the text
+        std::string input;
+        for (size_t i = 0; i < text.size(); i++) {
+            input += text[i];
+            if (gen() % 13 == 0) {
+                input += (gen() % 2) ? '\n' : ' ';
+            }
+        }
+        if (round % 4 == 3 && !input.empty()) {
+            input[gen() % input.size()] = static_cast<char>("v~z\x80\xff"[gen() % 5]);
+        }
+        
+        std::string expected;
+        bool expectedOk = decodeWith(simd::decodeScalar, input, expected);
+        if (round % 4 != 3) {
+            ASSERT_TRUE(expectedOk);
+            EXPECT_EQ(expected, binary);
+        }
+        
+        for (const auto& [kernel, supported] : kernels) {
+            if (!supported) {
+                continue;
+            }
+            std::string result;
+            EXPECT_EQ(decodeWith(kernel, input, result), expectedOk) << input;
+            if (expectedOk) {
+                EXPECT_EQ(result, expected);
+            }
+        }
+    }
+}
+
+TEST(ASCII85Test, DecoderAcrossChunks) {
+    std::string input = "Hello, World! This spans several groups.";
+    input += std::string(8, '\0');
+    std::string encoded = ASCII85::encode(input);
+    
+    for (size_t chunk = 1; chunk <= 7; chunk++) {
+        ASCII85::Decoder decoder;
+        std::string result;
+        std::vector<uint8_t> output(ASCII85::decodedSizeBound(chunk));
+        
+        for (size_t i = 0; i < encoded.size(); i += chunk) {
+            size_t length = std::min(chunk, encoded.size() - i);
+            size_t written = decoder.feed(encoded.data() + i, length, output.data());
+            result.append(reinterpret_cast<const char*>(output.data()), written);
+        }
+        size_t written = decoder.finish(output.data());
+        result.append(reinterpret_cast<const char*>(output.data()), written);
+        
+        EXPECT_EQ(result, input) << "chunk " << chunk;
+    }
+}
+
+TEST(ASCII85Test, DecoderFinishRejectsSingleChar) {
+    ASCII85::Decoder decoder;
+    std::vector<uint8_t> output(ASCII85::decodedSizeBound(6));
+    decoder.feed("6:4.06", 6, output.data());
+    EXPECT_THROW(decoder.finish(output.data()), std::runtime_error);
+}
+
+TEST(ASCII85Test, EncoderAcrossChunks) {
+    std::string input = "Hello, World! This spans several groups.";
+    input += std::string(8, '\0');
+    input += "tail";
+    std::string expected = ASCII85::encode(input);
+    
+    for (size_t chunk = 1; chunk <= 9; chunk++) {
+        ASCII85::Encoder encoder;
+        std::string result;
+        std::vector<char> output(ASCII85::encodedSizeBound(chunk + 3));
+        
+        for (size_t i = 0; i < input.size(); i += chunk) {
+            size_t length = std::min(chunk, input.size() - i);
+            size_t written = encoder.update(reinterpret_cast<const uint8_t*>(input.data()) + i,
+                                            length, output.data());
+            result.append(output.data(), written);
+        }
+        size_t written = encoder.finish(output.data());
+        result.append(output.data(), written);
+        
+        EXPECT_EQ(result, expected) << "chunk " << chunk;
+    }
+}
+
+// Blocks that are not a multiple of 4 bytes must not split groups
+TEST(ASCII85Test, StreamModeOddBlockSize) {
+    std::string input = "Hello, World! This spans several groups.";
+    std::stringstream in(input);
+    std::stringstream out;
+    
+    ASCII85::processStream(in, out, false, 7);
+    EXPECT_EQ(out.str(), ASCII85::encode(input));
+    
+    std::stringstream in2(out.str());
+    std::stringstream out2;
+    ASCII85::processStream(in2, out2, true, 3);
+    EXPECT_EQ(out2.str(), input);
+}
+
+TEST(ASCII85Test, MappedFileMode) {
+    std::string input = "Hello, World! This spans several groups.";
+    input += std::string(8, '\0');
+    
+    const std::string rawFile = "ascii85_mmap_test.bin";
+    const std::string encodedFile = "ascii85_mmap_test.a85";
+    const std::string decodedFile = "ascii85_mmap_test.out";
+    {
+        std::ofstream file(rawFile, std::ios::binary);
+        file << input;
+    }
+    
+    ASCII85::processFile(rawFile, encodedFile, false);
+    ASCII85::processFile(encodedFile, decodedFile, true);
+    
+    auto readAll = [](const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    };
+    EXPECT_EQ(readAll(encodedFile), ASCII85::encode(input));
+    EXPECT_EQ(readAll(decodedFile), input);
+    
+    std::remove(rawFile.c_str());
+    std::remove(encodedFile.c_str());
+    std::remove(decodedFile.c_str());
+}
+
+TEST(ASCII85Test, DescriptorMode) {
+    std::mt19937 gen(9);
+    std::string input(300000, '\0');
+    for (auto& byte : input) {
+        byte = static_cast<char>(gen() % 4 ? gen() : 0);
+    }
+    
+    const std::string inputFile = "ascii85_fd_test.in";
+    const std::string outputFile = "ascii85_fd_test.out";
+    auto run = [&](const std::string& data, ASCII85::Mode mode, bool decode) {
+        {
+            RawFile file = RawFile::create(inputFile);
+            file.write(data.data(), data.size());
+        }
+        {
+            RawFile in = RawFile::openRead(inputFile);
+            RawFile out = RawFile::create(outputFile);
+            ASCII85::process(in.descriptor(), out.descriptor(), mode, decode, 4093);
+        }
+        return RawFile::openRead(outputFile).readAll();
+    };
+    
+    std::string encoded = ASCII85::encode(input);
+    for (auto mode : {ASCII85::Mode::STREAM, ASCII85::Mode::BUFFER}) {
+        EXPECT_EQ(run(input, mode, false), encoded);
+        EXPECT_EQ(run(encoded, mode, true), input);
+    }
+    
+    std::remove(inputFile.c_str());
+    std::remove(outputFile.c_str());
+}
+
+TEST(ASCII85Test, ParallelMatchesSerial) {
+    std::mt19937 gen(7);
+    std::string input(ASCII85::MIN_PARALLEL_SIZE * 3 + 3, '\0');
+    for (size_t i = 0; i < input.size(); i++) {
+        // Long zero runs keep the 'z' shortcut in play across chunk boundaries
+        input[i] = (i / 4096) % 3 == 0 ? '\0' : static_cast<char>(gen());
+    }
+    std::string encoded = ASCII85::encode(input);
+    
+    // Line-wrap the text so chunk boundaries fall inside groups and whitespace
+    std::string wrapped;
+    for (size_t i = 0; i < encoded.size(); i += 77) {
+        wrapped += encoded.substr(i, 77);
+        wrapped += '\n';
+    }
+    
+    for (size_t threads : {2, 3, 8}) {
+        EXPECT_EQ(ASCII85::encodeParallel(input, threads), encoded);
+        EXPECT_EQ(ASCII85::decodeParallel(encoded, threads), input);
+        EXPECT_EQ(ASCII85::decodeParallel(wrapped, threads), input);
+    }
+}
+
+TEST(ASCII85Test, ParallelDecodeErrors) {
+    std::string encoded = ASCII85::encode(std::string(ASCII85::MIN_PARALLEL_SIZE * 2, 'x'));
+    
+    std::string outOfRange = encoded;
+    outOfRange[outOfRange.size() * 3 / 4] = '~';
+    EXPECT_THROW(ASCII85::decodeParallel(outOfRange, 4), std::runtime_error);
+    
+    std::string misplacedZ = encoded;
+    misplacedZ[misplacedZ.size() / 2 + 2] = 'z';
+    EXPECT_THROW(ASCII85::decodeParallel(misplacedZ, 4), std::runtime_error);
+    
+    EXPECT_THROW(ASCII85::decodeParallel(encoded + "!", 4), std::runtime_error);
+}
+
+// Framing and line breaks laid out after the fact, for comparison
+std::string layoutReference(const std::string& encoded, const EncodeOptions& options) {
+    std::string text = options.frame ? "<~" + encoded : encoded;
+    size_t width = options.effectiveLineWidth();
+    std::string result;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (width != 0 && i != 0 && i % width == 0) {
+            result += '\n';
+        }
+        result += text[i];
+    }
+    if (options.frame) {
+        size_t column = width == 0 || text.empty() ? text.size() : (text.size() - 1) % width + 1;
+        if (width != 0 && column + 2 > width) {
+            result += '\n';
+        }
+        result += "~>";
+    }
+    return result;
+}
+
+TEST(ASCII85Test, EncodeFramedAndWrapped) {
+    std::mt19937 gen(10);
+    for (size_t length = 0; length < 64; length++) {
+        std::string binary(length, '\0');
+        for (auto& byte : binary) {
+            byte = static_cast<char>(gen() % 3 ? gen() : 0);
+        }
+        for (bool frame : {false, true}) {
+            for (size_t width : {0, 1, 2, 3, 5, 7, 76}) {
+                EncodeOptions options{frame, width};
+                std::string encoded = ASCII85::encode(binary, options);
+                EXPECT_EQ(encoded, layoutReference(ASCII85::encode(binary), options))
+                    << length << " " << frame << " " << width;
+                EXPECT_LE(encoded.size(), ASCII85::encodedSizeBound(length, options));
+                EXPECT_EQ(ASCII85::decode(encoded), binary);
+            }
+        }
+    }
+    EXPECT_EQ(ASCII85::encode("", EncodeOptions{true, 0}), "<~~>");
+}
+
+TEST(ASCII85Test, EncoderWrappedAcrossChunks) {
+    std::mt19937 gen(11);
+    std::string binary(5000, '\0');
+    for (auto& byte : binary) {
+        byte = static_cast<char>(gen() % 4 ? gen() : 0);
+    }
+    EncodeOptions options{true, 76};
+    
+    ASCII85::Encoder encoder(options);
+    std::string result;
+    std::vector<char> buffer(ASCII85::encodedSizeBound(64 + 3, options));
+    for (size_t i = 0; i < binary.size();) {
+        size_t length = std::min<size_t>(gen() % 64 + 1, binary.size() - i);
+        size_t written = encoder.update(reinterpret_cast<const uint8_t*>(binary.data() + i), length,
+                                        buffer.data());
+        result.append(buffer.data(), written);
+        i += length;
+    }
+    size_t written = encoder.finish(buffer.data());
+    result.append(buffer.data(), written);
+    
+    EXPECT_EQ(result, ASCII85::encode(binary, options));
+}
+
+TEST(ASCII85Test, ParallelWrappedMatchesSerial) {
+    std::mt19937 gen(12);
+    std::string binary(3 * ASCII85::MIN_PARALLEL_SIZE + 3, '\0');
+    for (auto& byte : binary) {
+        byte = static_cast<char>(gen() % 5 ? gen() : 0);
+    }
+    
+    for (size_t width : {0, 2, 64, 76}) {
+        EncodeOptions options{true, width};
+        std::string serial = ASCII85::encode(binary, options);
+        EXPECT_EQ(ASCII85::encodeParallel(binary, 4, options), serial) << width;
+        EXPECT_EQ(ASCII85::decodeParallel(serial, 4), binary);
+    }
+}
+
+TEST(ASCII85Test, DecodeFrames) {
+    std::string encoded = ASCII85::encode("Hello, World!");
+    EXPECT_EQ(ASCII85::decode("<~" + encoded + "~>"), "Hello, World!");
+    EXPECT_EQ(ASCII85::decode(" \n<~" + encoded + "~>\n "), "Hello, World!");
+    EXPECT_EQ(ASCII85::decode(encoded + "~>"), "Hello, World!");
+    
+    // '<' is also a digit; it opens a frame only when '~' follows
+    EXPECT_EQ(ASCII85::decode("<<<<<"), ASCII85::decode("<~<<<<<~>"));
+    
+    EXPECT_THROW(ASCII85::decode("<~" + encoded + "~>x"), std::runtime_error);
+    EXPECT_THROW(ASCII85::decode("<~" + encoded + "~"), std::runtime_error);
+    EXPECT_THROW(ASCII85::decode("<~" + encoded + "~x~>"), std::runtime_error);
+    
+    // Delimiters split across feed() calls
+    std::string framed = "<~" + encoded + "~>";
+    for (size_t split = 0; split <= framed.size(); split++) {
+        ASCII85::Decoder decoder;
+        std::vector<uint8_t> output(ASCII85::decodedSizeBound(framed.size()));
+        size_t written = decoder.feed(framed.data(), split, output.data());
+        written += decoder.feed(framed.data() + split, framed.size() - split, output.data() + written);
+        written += decoder.finish(output.data() + written);
+        EXPECT_EQ(std::string(reinterpret_cast<const char*>(output.data()), written), "Hello, World!")
+            << split;
+    }
+}
+
+TEST(ASCII85Test, BatchFiles) {
+    std::vector<std::string> paths;
+    std::vector<std::string> contents;
+    for (int i = 0; i < 5; i++) {
+        paths.push_back("ascii85_batch_test_" + std::to_string(i) + ".bin");
+        contents.push_back(std::string(i * 1000, static_cast<char>('a' + i)) + "tail");
+        RawFile file = RawFile::create(paths.back());
+        file.write(contents.back().data(), contents.back().size());
+    }
+    
+    EXPECT_TRUE(ASCII85::processFiles(paths, false, 3, 1024).empty());
+    std::vector<std::string> encodedPaths;
+    for (size_t i = 0; i < paths.size(); i++) {
+        encodedPaths.push_back(paths[i] + ".a85");
+        EXPECT_EQ(RawFile::openRead(encodedPaths[i]).readAll(), ASCII85::encode(contents[i]));
+        std::remove(paths[i].c_str());
+    }
+    
+    EXPECT_TRUE(ASCII85::processFiles(encodedPaths, true, 3, 1024).empty());
+    for (size_t i = 0; i < paths.size(); i++) {
+        EXPECT_EQ(RawFile::openRead(paths[i]).readAll(), contents[i]);
+    }
+    
+    // Failures are reported per file and leave no output behind
+    {
+        RawFile file = RawFile::create("ascii85_batch_bad.a85");
+        file.write("abc~x", 5);
+    }
+    std::vector<std::string> errors = ASCII85::processFiles(
+        {"ascii85_batch_missing.a85", paths[0], "ascii85_batch_bad.a85"}, true, 2);
+    ASSERT_EQ(errors.size(), 3u);
+    EXPECT_EQ(errors[0].rfind("ascii85_batch_missing.a85: ", 0), 0u);
+    EXPECT_NE(errors[1].find("does not end in .a85"), std::string::npos);
+    EXPECT_NE(errors[2].find("character out of range"), std::string::npos);
+    EXPECT_FALSE(std::ifstream("ascii85_batch_bad"));
+    
+    std::remove("ascii85_batch_bad.a85");
+    for (size_t i = 0; i < paths.size(); i++) {
+        std::remove(paths[i].c_str());
+        std::remove(encodedPaths[i].c_str());
+    }
+}
+
+// Compares arrays in constant expressions (std::array's == is not
+// constexpr before C++20)
+template <typename T, size_t N>
+constexpr bool sameBytes(const std::array<T, N>& a, const char (&b)[N + 1]) {
+    for (size_t i = 0; i < N; i++) {
+        if (static_cast<char>(a[i]) != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr bool sameBytes(const std::array<uint8_t, N>& a, const std::array<uint8_t, N>& b) {
+    for (size_t i = 0; i < N; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(ASCII85Test, CompileTimeCodec) {
+    constexpr auto hello = ASCII85_DECODE("<~87cURD]i,\"Ebo7~>");
+    static_assert(sameBytes(hello, "Hello World"), "framed literal");
+    static_assert(sameBytes(ASCII85_DECODE(" 87cUR\nD]i,\"Ebo7 "), "Hello World"), "whitespace");
+    static_assert(ASCII85::decodedSize("z!!") == 5, "zero group and partial group");
+    
+    constexpr std::array<uint8_t, 9> data = {0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0x42};
+    constexpr auto text = ASCII85::encodeStatic<ASCII85::encodedSize(data)>(data);
+    static_assert(sameBytes(text, "zs8W-!63"), "encode");
+    static_assert(sameBytes(ASCII85_DECODE(text), data), "round trip");
+    
+    // At run time they agree with the regular codec
+    std::mt19937 gen(13);
+    for (int round = 0; round < 100; round++) {
+        std::string binary(gen() % 50, '\0');
+        for (auto& byte : binary) {
+            byte = static_cast<char>(gen() % 3 ? gen() : 0);
+        }
+        std::string encoded(ASCII85::encodedSizeBound(binary.size()), '\0');
+        encoded.resize(ASCII85::encodeConstexpr(reinterpret_cast<const uint8_t*>(binary.data()),
+                                                binary.size(), &encoded[0]));
+        EXPECT_EQ(encoded, ASCII85::encode(binary));
+        
+        std::string decoded(ASCII85::decodedSizeBound(encoded.size()), '\0');
+        decoded.resize(ASCII85::decodeConstexpr(encoded.data(), encoded.size(),
+                                                reinterpret_cast<uint8_t*>(&decoded[0])));
+        EXPECT_EQ(decoded, binary);
+    }
+    EXPECT_THROW(ASCII85::decodeConstexpr("s8W-\"", 5, nullptr), std::runtime_error);
+    EXPECT_THROW(ASCII85::decodeConstexpr("!!z!!", 5, nullptr), std::runtime_error);
+}
+
+TEST(ASCII85Test, AlphabetVariants) {
+    // Z85 reference vector from RFC 32
+    std::string hello("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B", 8);
+    EXPECT_EQ(Z85::encode(hello), "HelloWorld");
+    EXPECT_EQ(Z85::decode("Hello\nWorld"), hello);
+    EXPECT_THROW(Z85::encode("abc"), std::invalid_argument);
+    EXPECT_THROW(Z85::decode("HelloWor"), std::runtime_error);
+    EXPECT_THROW(Z85::decode("Hello~World"), std::runtime_error);
+    EncodeOptions framed;
+    framed.frame = true;
+    EXPECT_THROW(Z85::encode(hello, framed), std::invalid_argument);
+    
+    // RFC 1924 digits as Python's base64.b85encode uses them; '~' is a digit
+    EXPECT_EQ(RFC1924::encode("hello"), "Xk~0{Zv");
+    EXPECT_EQ(RFC1924::decode("Xk~0{Zv"), "hello");
+    EXPECT_EQ(RFC1924::encode(std::string(4, '\0')), "00000");
+    
+    // btoa shortcuts for zeros and spaces
+    std::string groups("    \0\0\0\0abc", 11);
+    EXPECT_EQ(Btoa::encode(groups), "yz@:E^");
+    EXPECT_EQ(Btoa::decode("yz@:E^"), groups);
+    EXPECT_THROW(Btoa::decode("@:y"), std::runtime_error);
+    EXPECT_EQ(ASCII85::encode(groups), "+<VdLz@:E^");
+    
+    static_assert(Z85::decodedSize("HelloWorld") == 8, "compile-time Z85");
+}
+
+// Every variant runs through the same kernels; they must agree with the
+// variant's scalar reference and decode their own output
+template <typename Alphabet>
+void checkVariantKernels() {
+    using Codec = Base85<Alphabet>;
+    std::mt19937 gen(85);
+    std::vector<std::pair<simd::EncodeKernel, bool>> encoders = {
+        {simd::encodeSSE41<Alphabet>, simd::hasSSE41()},
+        {simd::encodeAVX2<Alphabet>, simd::hasAVX2()},
+    };
+    
+    for (size_t size = 0; size < 400; size += 4) {
+        std::string binary(size, '\0');
+        for (size_t i = 0; i < size; i += 4) {
+            uint32_t kind = gen() % 4;
+            for (size_t j = i; j < i + 4; j++) {
+                binary[j] = kind == 0 ? '\0' : kind == 1 ? ' ' : static_cast<char>(gen());
+            }
+        }
+        const uint8_t* input = reinterpret_cast<const uint8_t*>(binary.data());
+        
+        std::vector<char> expected(Codec::encodedSizeBound(size));
+        char* end = expected.data();
+        simd::encodeScalar<Alphabet>(input, size, end);
+        std::string reference(expected.data(), end);
+        
+        for (const auto& [kernel, supported] : encoders) {
+            if (!supported) {
+                continue;
+            }
+            std::vector<char> output(Codec::encodedSizeBound(size));
+            char* out = output.data();
+            size_t consumed = kernel(input, size, out);
+            simd::encodeScalar<Alphabet>(input + consumed, size - consumed, out);
+            EXPECT_EQ(std::string(output.data(), out), reference) << Alphabet::NAME << " " << size;
+        }
+        
+        std::string text = Codec::encode(binary);
+        EXPECT_EQ(text, reference);
+        for (size_t i = text.size(); i > 0; i -= std::min<size_t>(i, gen() % 40 + 1)) {
+            text.insert(i, 1, '\n');
+        }
+        EXPECT_EQ(Codec::decode(text), binary) << Alphabet::NAME << " " << size;
+    }
+}
+
+TEST(ASCII85Test, AlphabetKernelsMatchScalar) {
+    checkVariantKernels<alphabet::Adobe>();
+    checkVariantKernels<alphabet::Btoa>();
+    checkVariantKernels<alphabet::Z85>();
+    checkVariantKernels<alphabet::Rfc1924>();
+}
+
+TEST(ASCII85Test, AlphabetParallelMatchesSerial) {
+    std::mt19937 gen(1924);
+    std::string binary(ASCII85::MIN_PARALLEL_SIZE + 4096, '\0');
+    for (size_t i = 0; i < binary.size(); i++) {
+        binary[i] = i % 64 < 8 ? ' ' : static_cast<char>(gen());
+    }
+    
+    std::string btoa = Btoa::encode(binary);
+    EXPECT_EQ(Btoa::encodeParallel(binary, 4), btoa);
+    EXPECT_EQ(Btoa::decodeParallel(btoa, 4), binary);
+    
+    std::string z85 = Z85::encode(binary);
+    EXPECT_EQ(Z85::encodeParallel(binary, 4), z85);
+    EXPECT_EQ(Z85::decodeParallel(z85, 4), binary);
+}
+
+TEST(ASCII85Test, Crc32cDigest) {
+    // Standard check value of CRC-32C
+    EXPECT_EQ(Crc32c::compute("123456789", 9), 0xE3069283u);
+    EXPECT_EQ(Crc32c::compute("", 0), 0u);
+    
+    // Appending separately computed digests equals one pass over the whole
+    std::mt19937 gen(32);
+    std::string data(100000, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(gen());
+    }
+    Crc32c combined;
+    for (size_t i = 0; i < data.size(); i += 7777) {
+        size_t length = std::min<size_t>(7777, data.size() - i);
+        combined.append(Crc32c::compute(data.data() + i, length), length);
+    }
+    EXPECT_EQ(combined.value(), Crc32c::compute(data.data(), data.size()));
+}
+
+TEST(ASCII85Test, ChecksumFusedIntoCodec) {
+    std::mt19937 gen(85);
+    std::string binary(ASCII85::MIN_PARALLEL_SIZE + 3 * ASCII85::CHECKSUM_SLICE + 5, '\0');
+    for (size_t i = 0; i < binary.size(); i++) {
+        binary[i] = i % 512 < 16 ? '\0' : static_cast<char>(gen());
+    }
+    uint32_t expected = Crc32c::compute(binary.data(), binary.size());
+    EncodeOptions wrapped;
+    wrapped.frame = true;
+    wrapped.lineWidth = 76;
+    
+    for (size_t threads : {1, 4}) {
+        Crc32c encodeSum;
+        std::string text = ASCII85::encodeParallel(binary, threads, EncodeOptions(), &encodeSum);
+        EXPECT_EQ(encodeSum.value(), expected) << threads;
+        
+        Crc32c wrappedSum;
+        std::string framed = ASCII85::encodeParallel(binary, threads, wrapped, &wrappedSum);
+        EXPECT_EQ(wrappedSum.value(), expected) << threads;
+        
+        Crc32c decodeSum;
+        EXPECT_EQ(ASCII85::decodeParallel(framed, threads, &decodeSum), binary);
+        EXPECT_EQ(decodeSum.value(), expected) << threads;
+    }
+    
+    // Stream mode through odd block sizes
+    std::string text = ASCII85::encode(binary);
+    Crc32c encodeSum;
+    Crc32c decodeSum;
+    std::istringstream rawInput(binary);
+    std::ostringstream encoded;
+    ASCII85::processStream(rawInput, encoded, false, 100003, EncodeOptions(), &encodeSum);
+    std::istringstream textInput(text);
+    std::ostringstream decoded;
+    ASCII85::processStream(textInput, decoded, true, 70001, EncodeOptions(), &decodeSum);
+    EXPECT_EQ(encodeSum.value(), expected);
+    EXPECT_EQ(decodeSum.value(), expected);
+    EXPECT_EQ(decoded.str(), binary);
+}
+
+// The final partial group must be summed by the chunk that decodes it, even
+// when whitespace after it leaves later chunks without any digits
+TEST(ASCII85Test, ParallelChecksumWithTrailingWhitespace) {
+    std::mt19937 gen(15);
+    std::string binary(ASCII85::MIN_PARALLEL_SIZE + 2, '\0');
+    for (auto& byte : binary) {
+        byte = static_cast<char>(gen());
+    }
+    uint32_t expected = Crc32c::compute(binary.data(), binary.size());
+    std::string text = ASCII85::encode(binary);
+    text.append(text.size(), '\n');
+    
+    for (bool trusted : {false, true}) {
+        Crc32c serialSum;
+        Crc32c parallelSum;
+        EXPECT_EQ(ASCII85::decodeParallel(text, 1, &serialSum, trusted), binary);
+        EXPECT_EQ(ASCII85::decodeParallel(text, 4, &parallelSum, trusted), binary);
+        EXPECT_EQ(serialSum.value(), expected);
+        EXPECT_EQ(parallelSum.value(), expected);
+    }
+}
+
+TEST(ASCII85Test, PipelineMatchesSerial) {
+    std::mt19937 gen(16);
+    std::string input(500003, '\0');
+    for (auto& byte : input) {
+        byte = static_cast<char>(gen() % 4 ? gen() : 0);
+    }
+    
+    const std::string inputFile = "ascii85_pipeline_test.in";
+    const std::string outputFile = "ascii85_pipeline_test.out";
+    auto run = [&](const std::string& data, bool decode, size_t workers, size_t depth,
+                   const EncodeOptions& options, Crc32c* checksum) {
+        {
+            RawFile file = RawFile::create(inputFile);
+            file.write(data.data(), data.size());
+        }
+        {
+            RawFile in = RawFile::openRead(inputFile);
+            RawFile out = RawFile::create(outputFile);
+            ASCII85::processPipeline(in.descriptor(), out.descriptor(), decode, 4093, workers,
+                                     depth, options, checksum);
+        }
+        return RawFile::openRead(outputFile).readAll();
+    };
+    
+    EncodeOptions wrapped;
+    wrapped.frame = true;
+    wrapped.lineWidth = 75;
+    uint32_t expected = Crc32c::compute(input.data(), input.size());
+    for (size_t workers : {1, 3}) {
+        for (size_t depth : {1, 2, 7}) {
+            for (const auto& options : {EncodeOptions(), wrapped}) {
+                Crc32c encodeSum;
+                Crc32c decodeSum;
+                std::string encoded = ASCII85::encode(input, options);
+                EXPECT_EQ(run(input, false, workers, depth, options, &encodeSum), encoded);
+                EXPECT_EQ(run(encoded, true, workers, depth, options, &decodeSum), input);
+                EXPECT_EQ(encodeSum.value(), expected) << workers << " " << depth;
+                EXPECT_EQ(decodeSum.value(), expected) << workers << " " << depth;
+            }
+        }
+    }
+    
+    // An error in the codec stage stops the pipeline and reaches the caller
+    std::string broken = ASCII85::encode(input);
+    broken[broken.size() / 2] = 'w';
+    EXPECT_THROW(run(broken, true, 1, 4, EncodeOptions(), nullptr), std::runtime_error);
+    
+    std::remove(inputFile.c_str());
+    std::remove(outputFile.c_str());
+}
+
+// Trusted decoding skips validation but must decode valid text exactly
+// like the validating path, through every kernel
+template <typename Alphabet>
+void checkTrustedKernels() {
+    using Codec = Base85<Alphabet>;
+    std::mt19937 gen(17);
+    std::vector<std::pair<simd::DecodeKernel, bool>> decoders = {
+        {simd::decodeTrustedScalar<Alphabet>, true},
+        {simd::decodeTrustedSSE41<Alphabet>, simd::hasSSE41()},
+        {simd::decodeTrustedAVX2<Alphabet>, simd::hasAVX2()},
+    };
+    
+    for (size_t size = 0; size < 600; size += 4) {
+        std::string binary(size, '\0');
+        for (size_t i = 0; i < size; i += 4) {
+            uint32_t kind = gen() % 8;
+            for (size_t j = i; j < i + 4; j++) {
+                binary[j] = kind == 0 ? '\0' : kind == 1 ? ' ' : static_cast<char>(gen());
+            }
+        }
+        
+        std::string text = Codec::encode(binary);
+        for (size_t i = text.size(); i > 0; i -= std::min<size_t>(i, gen() % 60 + 1)) {
+            text.insert(i, 1, gen() % 2 ? '\n' : ' ');
+        }
+        EXPECT_EQ(Codec::decode(text, true), binary) << Alphabet::NAME << " " << size;
+        
+        for (const auto& [kernel, supported] : decoders) {
+            if (!supported) {
+                continue;
+            }
+            std::vector<uint8_t> output(Codec::decodedSizeBound(text.size()));
+            uint8_t* out = output.data();
+            simd::DecodeState state;
+            size_t i = 0;
+            while (i < text.size()) {
+                i += kernel(text.data() + i, text.size() - i, out, state);
+                i += simd::decodeTrustedScalar<Alphabet>(text.data() + i,
+                                                         std::min<size_t>(text.size() - i, 16),
+                                                         out, state);
+            }
+            simd::decodeFinish<Alphabet>(state, out);
+            EXPECT_EQ(std::string(output.begin(), output.begin() + (out - output.data())), binary)
+                << Alphabet::NAME << " " << size;
+        }
+    }
+}
+
+TEST(ASCII85Test, TrustedDecodeMatchesValidated) {
+    checkTrustedKernels<alphabet::Adobe>();
+    checkTrustedKernels<alphabet::Btoa>();
+    checkTrustedKernels<alphabet::Z85>();
+    checkTrustedKernels<alphabet::Rfc1924>();
+    
+    // Frames, line breaks and the parallel path
+    std::mt19937 gen(18);
+    std::string binary(ASCII85::MIN_PARALLEL_SIZE + 1001, '\0');
+    for (size_t i = 0; i < binary.size(); i++) {
+        binary[i] = i % 256 < 8 ? '\0' : static_cast<char>(gen());
+    }
+    EncodeOptions options;
+    options.frame = true;
+    options.lineWidth = 76;
+    std::string text = ASCII85::encode(binary, options);
+    EXPECT_EQ(ASCII85::decode(text, true), binary);
+    EXPECT_EQ(ASCII85::decodeParallel(text, 4, nullptr, true), binary);
+    
+    ASCII85::Decoder decoder(true);
+    std::vector<uint8_t> output(ASCII85::decodedSizeBound(text.size()));
+    size_t written = 0;
+    for (size_t i = 0; i < text.size(); i += 777) {
+        size_t length = std::min<size_t>(777, text.size() - i);
+        written += decoder.feed(text.data() + i, length, output.data() + written);
+    }
+    written += decoder.finish(output.data() + written);
+    EXPECT_EQ(std::string(output.begin(), output.begin() + written), binary);
+}
+
+TEST(ASCII85Test, TrustedDecodeStaysInsideExactOutput) {
+    // Guard bytes right after the data catch a store past it in any build
+    std::vector<std::string> texts = {
+        ASCII85::encode(std::string("hello")),
+        ASCII85::encode(std::string(8, '\0')),
+        ASCII85::encode(std::string("hello world!!")) + "\n\n",
+        ASCII85::encode(std::string("hello world!")) + " \n\n",
+    };
+    for (const auto& text : texts) {
+        std::string binary = ASCII85::decode(text);
+        std::vector<uint8_t> output(binary.size() + 16, 0xA5);
+        uint8_t* out = output.data();
+        simd::DecodeState state;
+        size_t consumed = simd::decodeTrustedScalar<alphabet::Adobe>(text.data(), text.size(), out,
+                                                                     state);
+        simd::decodeFinish<alphabet::Adobe>(state, out);
+        EXPECT_EQ(consumed, text.size());
+        ASSERT_EQ(static_cast<size_t>(out - output.data()), binary.size()) << text;
+        EXPECT_EQ(std::string(output.begin(), output.begin() + binary.size()), binary);
+        for (size_t i = binary.size(); i < output.size(); i++) {
+            EXPECT_EQ(output[i], 0xA5) << text << " guard byte " << i - binary.size();
+        }
+    }
+    
+    // The parallel path decodes into an exactly sized buffer shared by the
+    // chunks; a sanitizer build reports any store past a chunk's end
+    std::mt19937 gen(20);
+    std::string binary(ASCII85::MIN_PARALLEL_SIZE + 1, '\0');
+    for (auto& c : binary) {
+        c = static_cast<char>(gen());
+    }
+    EXPECT_EQ(ASCII85::decodeParallel(ASCII85::encode(binary), 4, nullptr, true), binary);
+    EncodeOptions options;
+    options.lineWidth = 76;
+    std::string text = ASCII85::encode(binary, options) + "\n\n";
+    EXPECT_EQ(ASCII85::decodeParallel(text, 4, nullptr, true), binary);
+}
+
+TEST(ASCII85Test, TrustedDecodeOfGarbageStaysInBounds) {
+    // Malformed text gives unspecified bytes, but never more than the bound
+    std::mt19937 gen(19);
+    for (size_t size = 1; size < 2000; size += 37) {
+        std::string text(size, '\0');
+        for (auto& c : text) {
+            c = static_cast<char>(gen() % 4 ? '!' + gen() % 90 : gen());
+        }
+        std::vector<uint8_t> output(ASCII85::decodedSizeBound(size));
+        ASCII85::Decoder decoder(true);
+        
+        // Only the delimiters and the trailing group are still checked
+        try {
+            size_t written = decoder.feed(text.data(), size, output.data());
+            EXPECT_LE(written, output.size());
+            written += decoder.finish(output.data() + written);
+            EXPECT_LE(written, output.size());
+        } catch (const std::runtime_error&) {
+        }
+    }
+}
+
+TEST(ASCII85Test, StatsCountTheCodedData) {
+    // 250 groups of which 50 are zero, then a partial group of 2 bytes
+    std::mt19937 gen(18);
+    std::string binary(1002, '\0');
+    for (size_t i = 200; i < binary.size(); i++) {
+        binary[i] = static_cast<char>(gen() | 1);
+    }
+    EncodeOptions wrapped;
+    wrapped.frame = true;
+    wrapped.lineWidth = 60;
+    std::string text = ASCII85::encode(binary, wrapped);
+    size_t lineBreaks = std::count(text.begin(), text.end(), '\n');
+    
+    for (size_t blockSize : {size_t(97), ASCII85::DEFAULT_BLOCK_SIZE}) {
+        Stats encodeStats;
+        std::istringstream rawInput(binary);
+        std::ostringstream encoded;
+        ASCII85::processStream(rawInput, encoded, false, blockSize, wrapped, nullptr, &encodeStats);
+        EXPECT_EQ(encoded.str(), text);
+        EXPECT_EQ(encodeStats.bytesIn, binary.size());
+        EXPECT_EQ(encodeStats.bytesOut, text.size());
+        EXPECT_EQ(encodeStats.groups, 251u);
+        EXPECT_EQ(encodeStats.shortcutGroups, 50u);
+        EXPECT_EQ(encodeStats.whitespace, lineBreaks);
+        EXPECT_GT(encodeStats.peakBuffer, blockSize);
+        
+        // Decoding skips the line breaks and the delimiters
+        Stats decodeStats;
+        std::istringstream textInput(text);
+        std::ostringstream decoded;
+        ASCII85::processStream(textInput, decoded, true, blockSize, EncodeOptions(), nullptr,
+                               &decodeStats);
+        EXPECT_EQ(decoded.str(), binary);
+        EXPECT_EQ(decodeStats.bytesIn, text.size());
+        EXPECT_EQ(decodeStats.bytesOut, binary.size());
+        EXPECT_EQ(decodeStats.groups, 251u);
+        EXPECT_EQ(decodeStats.shortcutGroups, 50u);
+        EXPECT_EQ(decodeStats.whitespace, lineBreaks + 4);
+    }
+    
+    // Buffer mode adds up over several inputs
+    Stats stats;
+    for (int i = 0; i < 2; i++) {
+        std::ostringstream encoded;
+        ASCII85::processBuffer(binary, encoded, false, 1, EncodeOptions(), nullptr, &stats);
+    }
+    EXPECT_EQ(stats.bytesIn, 2 * binary.size());
+    EXPECT_EQ(stats.groups, 502u);
+    EXPECT_EQ(stats.shortcutGroups, 100u);
+    EXPECT_EQ(stats.whitespace, 0u);
+    EXPECT_NE(stats.toJson().find("\"shortcut_groups\":100,"), std::string::npos);
+    
+    // Buffer mode decoding takes the shortcuts from the decoder
+    Stats bufferDecodeStats;
+    std::ostringstream decoded;
+    ASCII85::processBuffer(text, decoded, true, 4, EncodeOptions(), nullptr, &bufferDecodeStats);
+    EXPECT_EQ(decoded.str(), binary);
+    EXPECT_EQ(bufferDecodeStats.shortcutGroups, 50u);
+    EXPECT_EQ(bufferDecodeStats.whitespace, lineBreaks + 4);
+    
+    // Line breaks follow from the size of the wrapped text, the end marker
+    // moved to its own line included
+    EXPECT_EQ(Stats::lineBreaks(text.size(), 60), lineBreaks);
+    for (size_t width : {2, 3, 7}) {
+        for (size_t size = 0; size < 40; size++) {
+            EncodeOptions options;
+            options.frame = true;
+            options.lineWidth = width;
+            std::string encoded = ASCII85::encode(binary.substr(200, size), options);
+            EXPECT_EQ(Stats::lineBreaks(encoded.size(), width),
+                      static_cast<uint64_t>(std::count(encoded.begin(), encoded.end(), '\n')))
+                << width << " " << size;
+        }
+    }
+}
@@ -0,0 +1,345 @@
+#pragma once
+
+// Differential checks shared by the property test and the fuzz target.
+// Every codec path (each vector kernel, the incremental encoder and decoder
+// under arbitrary chunk splits, stream mode, the parallel and trusted
+// paths) must produce exactly what the constexpr reference codec produces,
+// which is plain scalar C++ sharing no code with them, and the fused
+// checksums of the parallel paths must match a digest of the data. Malformed
+// input must raise the same error (exception type and message) on every path.
+//
+// The checks return a description of the first mismatch, or an empty
+// string when all paths agree.
+
+#include "ascii85.hpp"
+#include "ascii85_simd.hpp"
+#include "crc32c.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ascii85 {
+namespace differential {
+
+// What one path produced: its output, or the error it raised
+struct Outcome {
+    bool failed = false;
+    std::string value; // output, or "<type>: <message>"
+
+    bool operator==(const Outcome& other) const {
+        return failed == other.failed && value == other.value;
+    }
+    bool operator!=(const Outcome& other) const { return !(*this == other); }
+};
+
+template <typename F>
+Outcome attempt(F&& run) {
+    try {
+        return {false, run()};
+    } catch (const std::invalid_argument& e) {
+        return {true, std::string("invalid_argument: ") + e.what()};
+    } catch (const std::runtime_error& e) {
+        return {true, std::string("runtime_error: ") + e.what()};
+    }
+}
+
+// Short printable form of an outcome for mismatch reports
+inline std::string describe(const Outcome& outcome) {
+    if (outcome.failed) {
+        return outcome.value;
+    }
+    std::string text = std::to_string(outcome.value.size()) + " bytes: ";
+    for (size_t i = 0; i < outcome.value.size() && i < 24; i++) {
+        const char* hex = "0123456789abcdef";
+        unsigned char c = static_cast<unsigned char>(outcome.value[i]);
+        text += hex[c >> 4];
+        text += hex[c & 15];
+    }
+    return outcome.value.size() > 24 ? text + "..." : text;
+}
+
+// splitmix64, so split points depend on nothing but the seed
+inline uint64_t nextRandom(uint64_t& seed) {
+    uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Chunk lengths covering `length`, mixing single chars, odd sizes and
+// long runs so that splits land inside groups, shortcuts and delimiters
+inline std::vector<size_t> chunks(size_t length, uint64_t seed) {
+    std::vector<size_t> sizes;
+    for (size_t done = 0; done < length;) {
+        uint64_t r = nextRandom(seed);
+        size_t size = r % 4 == 0 ? 1 : r % 4 == 1 ? r % 7 + 1 : r % 4 == 2 ? r % 97 + 1
+                                                              : r % 70000 + 1;
+        size = std::min(size, length - done);
+        sizes.push_back(size);
+        done += size;
+    }
+    return sizes;
+}
+
+// Records the first mismatch between a path and the reference
+class Report {
+public:
+    explicit Report(std::string context) : context(std::move(context)) {}
+
+    void expect(const char* path, const Outcome& actual, const Outcome& expected) {
+        if (message.empty() && actual != expected) {
+            message = context + ": " + path + " gave " + describe(actual) + ", expected " +
+                      describe(expected);
+        }
+    }
+
+    void expect(const char* path, bool holds) {
+        if (message.empty() && !holds) {
+            message = context + ": " + path + " does not hold";
+        }
+    }
+
+    const std::string& result() const { return message; }
+
+private:
+    std::string context;
+    std::string message;
+};
+
+// Runs a decoder kernel the way the codec does, handing whatever it stops
+// at to the scalar decoder, then flushes the trailing group
+inline std::string decodeThrough(simd::DecodeKernel kernel, simd::DecodeKernel scalar,
+                                 void (*finish)(simd::DecodeState&, uint8_t*&),
+                                 const std::string& text) {
+    std::vector<uint8_t> output(text.size() * 4 + 4);
+    uint8_t* out = output.data();
+    simd::DecodeState state;
+    size_t i = 0;
+    while (i < text.size()) {
+        if (kernel != nullptr) {
+            i += kernel(text.data() + i, text.size() - i, out, state);
+        }
+        size_t step = std::min(text.size() - i, size_t(16));
+        size_t consumed = scalar(text.data() + i, step, out, state);
+        i += consumed;
+        if (consumed < step) {
+            break;
+        }
+    }
+    finish(state, out);
+    return std::string(output.data(), out);
+}
+
+// Encodes `data` on every path. `seed` picks the chunk splits and the line
+// width of the wrapped checks.
+template <typename Alphabet>
+std::string checkEncode(const std::string& data, uint64_t seed) {
+    using Codec = Base85<Alphabet>;
+    Report report(std::string(Alphabet::NAME) + " encode of " + std::to_string(data.size()) +
+                  " bytes, seed " + std::to_string(seed));
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    size_t length = data.size();
+
+    Outcome reference = attempt([&] {
+        std::string text(Codec::encodeConstexpr(bytes, length, nullptr), '\0');
+        Codec::encodeConstexpr(bytes, length, &text[0]);
+        return text;
+    });
+
+    report.expect("encode", attempt([&] { return Codec::encode(data); }), reference);
+
+    // Each kernel on its own, the scalar path finishing what it leaves
+    std::vector<std::pair<const char*, simd::EncodeKernel>> kernels = {{"scalar", nullptr}};
+    if (simd::hasSSE41()) {
+        kernels.push_back({"encodeSSE41", simd::encodeSSE41<Alphabet>});
+    }
+    if (simd::hasAVX2()) {
+        kernels.push_back({"encodeAVX2", simd::encodeAVX2<Alphabet>});
+    }
+    if (!reference.failed) {
+        for (const auto& [name, kernel] : kernels) {
+            std::string text(Codec::encodedSizeBound(length), '\0');
+            char* out = &text[0];
+            size_t consumed = kernel != nullptr ? kernel(bytes, length, out) : 0;
+            simd::encodeScalar<Alphabet>(bytes + consumed, length - consumed, out);
+            text.resize(out - text.data());
+            report.expect(name, {false, text}, reference);
+        }
+    }
+
+    auto encodeChunked = [&](const EncodeOptions& options) {
+        typename Codec::Encoder encoder(options);
+        std::string text;
+        std::vector<char> scratch(Codec::encodedSizeBound(length + 3, options) +
+                                  Codec::encodedSizeBound(3, options));
+        size_t done = 0;
+        for (size_t size : chunks(length, seed)) {
+            size_t written = encoder.update(bytes + done, size, scratch.data());
+            text.append(scratch.data(), written);
+            done += size;
+        }
+        text.append(scratch.data(), encoder.finish(scratch.data()));
+        return text;
+    };
+    report.expect("Encoder", attempt([&] { return encodeChunked(EncodeOptions()); }), reference);
+    report.expect("encodeParallel",
+                  attempt([&] { return Codec::encodeParallel(data, 3); }), reference);
+    report.expect("processStream", attempt([&] {
+        std::istringstream input(data);
+        std::ostringstream output;
+        Codec::processStream(input, output, false, seed % 97 + 1);
+        return output.str();
+    }), reference);
+    if (reference.failed) {
+        return report.result();
+    }
+    Crc32c encodeSum;
+    Codec::encodeParallel(data, 3, EncodeOptions(), &encodeSum);
+    report.expect("encodeParallel checksum",
+                  encodeSum.value() == Crc32c::compute(data.data(), data.size()));
+
+    // Round trips
+    const std::string& text = reference.value;
+    Outcome original{false, data};
+    report.expect("decode", attempt([&] { return Codec::decode(text); }), original);
+    report.expect("trusted decode", attempt([&] { return Codec::decode(text, true); }),
+                  original);
+    report.expect("decodeParallel",
+                  attempt([&] { return Codec::decodeParallel(text, 3); }), original);
+
+    // Framed and wrapped output is the same text with delimiters and breaks
+    EncodeOptions options;
+    options.frame = Alphabet::FRAMES && seed % 2 == 0;
+    options.lineWidth = seed % 3 == 0 ? 0 : seed % 80 + 1;
+    Outcome wrapped = attempt([&] { return Codec::encode(data, options); });
+    report.expect("Encoder with options", attempt([&] { return encodeChunked(options); }),
+                  wrapped);
+    report.expect("encodeParallel with options",
+                  attempt([&] { return Codec::encodeParallel(data, 3, options); }), wrapped);
+    if (!wrapped.failed) {
+        std::string lines = wrapped.value;
+        std::string joined;
+        size_t width = 0;
+        size_t longest = 0;
+        for (char c : lines) {
+            if (c == '\n') {
+                width = 0;
+                continue;
+            }
+            joined += c;
+            longest = std::max(longest, ++width);
+        }
+        if (options.frame) {
+            joined = joined.substr(2, joined.size() - 4);
+        }
+        report.expect("stripped options", {false, joined}, reference);
+        report.expect("line width", options.lineWidth == 0 ||
+                                        longest <= options.effectiveLineWidth());
+        report.expect("decode with options", attempt([&] { return Codec::decode(lines); }),
+                      original);
+        report.expect("trusted decode with options",
+                      attempt([&] { return Codec::decode(lines, true); }), original);
+    }
+    return report.result();
+}
+
+// Decodes `text` on every path; malformed text must fail the same way
+// everywhere. `seed` picks the chunk splits.
+template <typename Alphabet>
+std::string checkDecode(const std::string& text, uint64_t seed) {
+    using Codec = Base85<Alphabet>;
+    Report report(std::string(Alphabet::NAME) + " decode of " + std::to_string(text.size()) +
+                  " chars, seed " + std::to_string(seed));
+    size_t length = text.size();
+
+    Outcome reference = attempt([&] {
+        std::string data(Codec::decodeConstexpr(text.data(), length, nullptr), '\0');
+        Codec::decodeConstexpr(text.data(), length, reinterpret_cast<uint8_t*>(&data[0]));
+        return data;
+    });
+
+    report.expect("decode", attempt([&] { return Codec::decode(text); }), reference);
+    report.expect("Decoder", attempt([&] {
+        typename Codec::Decoder decoder;
+        std::string data;
+        std::vector<uint8_t> scratch(Codec::decodedSizeBound(length) + 4);
+        size_t done = 0;
+        for (size_t size : chunks(length, seed)) {
+            size_t written = decoder.feed(text.data() + done, size, scratch.data());
+            data.append(reinterpret_cast<const char*>(scratch.data()), written);
+            done += size;
+        }
+        size_t written = decoder.finish(scratch.data());
+        return data.append(reinterpret_cast<const char*>(scratch.data()), written);
+    }), reference);
+    report.expect("decodeParallel",
+                  attempt([&] { return Codec::decodeParallel(text, 3); }), reference);
+    report.expect("processStream", attempt([&] {
+        std::istringstream input(text);
+        std::ostringstream output;
+        Codec::processStream(input, output, true, seed % 97 + 1);
+        return output.str();
+    }), reference);
+
+    // The kernels on the body (up to an end marker), against the scalar path
+    Outcome scalar = attempt([&] {
+        return decodeThrough(nullptr, simd::decodeScalar<Alphabet>, simd::decodeFinish<Alphabet>,
+                             text);
+    });
+    if (simd::hasSSE41()) {
+        report.expect("decodeSSE41", attempt([&] {
+            return decodeThrough(simd::decodeSSE41<Alphabet>, simd::decodeScalar<Alphabet>,
+                                 simd::decodeFinish<Alphabet>, text);
+        }), scalar);
+    }
+    if (simd::hasAVX2()) {
+        report.expect("decodeAVX2", attempt([&] {
+            return decodeThrough(simd::decodeAVX2<Alphabet>, simd::decodeScalar<Alphabet>,
+                                 simd::decodeFinish<Alphabet>, text);
+        }), scalar);
+    }
+
+    // Trusted decoding validates nothing, so it must only agree on valid
+    // text; on anything else it must merely stay in bounds
+    Outcome trusted = attempt([&] { return Codec::decode(text, true); });
+    Outcome trustedParallel = attempt([&] { return Codec::decodeParallel(text, 3, nullptr, true); });
+    if (!reference.failed) {
+        report.expect("trusted decode", trusted, reference);
+        report.expect("trusted decodeParallel", trustedParallel, reference);
+
+        // The per-chunk digests must combine to the digest of the output
+        uint32_t expected = Crc32c::compute(reference.value.data(), reference.value.size());
+        for (bool trustedSum : {false, true}) {
+            Crc32c decodeSum;
+            Codec::decodeParallel(text, 3, &decodeSum, trustedSum);
+            report.expect(trustedSum ? "trusted decodeParallel checksum"
+                                     : "decodeParallel checksum",
+                          decodeSum.value() == expected);
+        }
+    }
+    return report.result();
+}
+
+// Both checks on every variant, the input taken as data and as text
+inline std::string checkAll(const std::string& input, uint64_t seed) {
+    std::string failures[] = {
+        checkEncode<alphabet::Adobe>(input, seed),   checkDecode<alphabet::Adobe>(input, seed),
+        checkEncode<alphabet::Btoa>(input, seed),    checkDecode<alphabet::Btoa>(input, seed),
+        checkEncode<alphabet::Z85>(input, seed),     checkDecode<alphabet::Z85>(input, seed),
+        checkEncode<alphabet::Rfc1924>(input, seed), checkDecode<alphabet::Rfc1924>(input, seed),
+    };
+    for (const auto& failure : failures) {
+        if (!failure.empty()) {
+            return failure;
+        }
+    }
+    return "";
+}
+
+} // namespace differential
+} // namespace ascii85
@@ -1,9 +1,12 @@
 #ifndef GAUSSIAN_ELIMINATION_HPP
 #define GAUSSIAN_ELIMINATION_HPP
 
+#include "npy_io.hpp"
+#include "parallel.hpp"
 #include <Eigen/Dense>
 #include <string>
 #include <stdexcept>
+#include <type_traits>
 
 namespace GaussianSolver {
 
@@ -19,6 +22,14 @@ public:
 /**
  * @brief Reads an augmented matrix [A|b] from a CSV file.
  * 
+ * Any number of right-hand side columns may follow A, so an N x (N+K) file
+ * holds the system [A|B] with K right-hand sides. A first line that does not
+ * start with a number is a header and is skipped; blank lines are ignored.
+ * 
+ * The file is memory-mapped and parsed with std::from_chars straight into
+ * the matrix, in two passes (count the rows, then parse). Files of 1 MB or
+ * more are split at line boundaries across getNumThreads() threads.
+ * 
  * @param filename Path to the CSV file
  * @return Eigen::MatrixXd The augmented matrix
  * @throws std::runtime_error if file cannot be opened or format is invalid
@@ -29,6 +40,11 @@ Eigen::MatrixXd readAugmentedMatrixFromCSV(const std::string& filename);
  * @brief Solves a system of linear equations Ax = b using Gaussian elimination
  *        with partial pivoting.
  * 
+ * The elimination is a blocked LU factorization: each panel of columns is
+ * factored on its own, and the rest of the matrix is updated with one matrix
+ * product per panel (BLAS GEMM when built with USE_BLAS). The updates are
+ * split into column tiles across getNumThreads() threads.
+ * 
  * @param augmentedMatrix An N x (N+1) Eigen matrix representing [A|b]
  * @param epsilon A small value to check for near-zero pivots
  * @return Eigen::VectorXd The solution vector x
@@ -36,6 +52,75 @@ Eigen::MatrixXd readAugmentedMatrixFromCSV(const std::string& filename);
  */
 Eigen::VectorXd solve(const Eigen::MatrixXd& augmentedMatrix, double epsilon = 1e-10);
 
+/**
+ * @brief Solves Ax = b like solve(), but eliminates in the caller's matrix
+ *        instead of a copy, so no second N x (N+1) buffer is allocated.
+ * 
+ * Any number of right-hand side columns may follow A. On return the leading
+ * N columns hold the packed LU factors and the trailing columns hold the
+ * solutions, one per right-hand side. If an exception is thrown the matrix
+ * is left partly eliminated.
+ * 
+ * @param augmentedMatrix An N x (N+K) matrix [A|B], K >= 1, overwritten
+ * @param epsilon A small value to check for near-zero pivots
+ * @throws std::invalid_argument if there is no right-hand side column
+ * @throws SingularMatrixException if the system is singular or has no unique solution
+ */
+void solveInPlace(Eigen::Ref<Eigen::MatrixXd> augmentedMatrix, double epsilon = 1e-10);
+
+/**
+ * @brief LU factorization with partial pivoting (PA = LU) of a square
+ *        coefficient matrix, computed once and reused for any number of
+ *        right-hand sides.
+ * 
+ * Uses the same blocked elimination as solve(). Each solve costs O(n^2)
+ * per right-hand side column; several columns are solved in parallel.
+ */
+class Factorization {
+public:
+    /**
+     * @brief Factors the coefficient matrix A.
+     * 
+     * @param A An N x N coefficient matrix
+     * @param epsilon A small value to check for near-zero pivots
+     * @throws std::invalid_argument if A is not square
+     * @throws SingularMatrixException if A is singular
+     */
+    explicit Factorization(const Eigen::MatrixXd& A, double epsilon = 1e-10);
+    
+    /**
+     * @brief Solves AX = B for one or several right-hand sides at once.
+     * 
+     * Any Eigen expression is accepted, e.g. M.col(j) or M.rightCols(k).
+     * Expressions with a single column at compile time (vectors, columns)
+     * return a vector, everything else a matrix.
+     * 
+     * @param B An N x K matrix or an N-element vector, one right-hand side per column
+     * @return Eigen::VectorXd or Eigen::MatrixXd The N x K solutions, one per column
+     * @throws std::invalid_argument if B has the wrong number of rows
+     */
+    template <typename Derived>
+    std::conditional_t<Derived::ColsAtCompileTime == 1, Eigen::VectorXd, Eigen::MatrixXd>
+    solve(const Eigen::MatrixBase<Derived>& B) const {
+        return solveColumns(B);
+    }
+    
+    /** @brief Number of equations (and unknowns). */
+    int size() const { return static_cast<int>(lu_.rows()); }
+    
+    /** @brief Packed factors: unit lower L below the diagonal, U on and above it. */
+    const Eigen::MatrixXd& factors() const { return lu_; }
+    
+    /** @brief Row swapped with row k at elimination step k. */
+    const Eigen::VectorXi& pivots() const { return pivots_; }
+
+private:
+    Eigen::MatrixXd solveColumns(const Eigen::Ref<const Eigen::MatrixXd>& B) const;
+    
+    Eigen::MatrixXd lu_;
+    Eigen::VectorXi pivots_;
+};
+
 /**
  * @brief Writes a solution vector to a CSV file.
  * 
@@ -45,6 +130,16 @@ Eigen::VectorXd solve(const Eigen::MatrixXd& augmentedMatrix, double epsilon = 1
  */
 void writeSolutionToCSV(const std::string& filename, const Eigen::VectorXd& solution);
 
+/**
+ * @brief Writes the solutions of several right-hand sides to a CSV file,
+ *        one column per right-hand side.
+ * 
+ * @param filename Path to the output CSV file
+ * @param solutions The N x K solution matrix to write
+ * @throws std::runtime_error if the file cannot be opened/written
+ */
+void writeSolutionToCSV(const std::string& filename, const Eigen::MatrixXd& solutions);
+
 /**
  * @brief Generates a random augmented matrix [A|b].
  * 
@@ -59,6 +154,62 @@ Eigen::MatrixXd generateRandomSystem(int num_variables,
                                      double max_val = 10.0,
                                      unsigned int seed = 0);
 
+/**
+ * @brief File formats for matrices and solutions.
+ */
+enum class FileFormat {
+    Auto,  ///< Chosen by file extension: .npy is Npy, anything else Csv
+    Csv,   ///< Comma-separated text with a header row
+    Npy    ///< NumPy .npy, little-endian float64
+};
+
+/**
+ * @brief Parses a format name: "auto", "csv" or "npy".
+ * 
+ * @throws std::invalid_argument for any other name
+ */
+FileFormat parseFileFormat(const std::string& name);
+
+/**
+ * @brief Resolves FileFormat::Auto from the file extension; other formats are
+ *        returned unchanged.
+ */
+FileFormat resolveFileFormat(const std::string& filename, FileFormat format);
+
+/**
+ * @brief Reads an augmented matrix [A|B] from a CSV or .npy file.
+ * 
+ * @param filename Path to the file
+ * @param format File format, by default chosen by extension
+ * @return Eigen::MatrixXd The augmented matrix
+ * @throws std::runtime_error if the file cannot be read or format is invalid
+ */
+Eigen::MatrixXd readAugmentedMatrix(const std::string& filename, 
+                                    FileFormat format = FileFormat::Auto);
+
+/**
+ * @brief Writes solutions, one column per right-hand side, to a CSV or .npy
+ *        file. A single solution is written as a vector.
+ * 
+ * @param filename Path to the output file
+ * @param solutions The N x K solution matrix to write
+ * @param format File format, by default chosen by extension
+ * @throws std::runtime_error if the file cannot be opened/written
+ */
+void writeSolution(const std::string& filename, const Eigen::MatrixXd& solutions,
+                   FileFormat format = FileFormat::Auto);
+
+/**
+ * @brief Writes a matrix to a CSV or .npy file.
+ * 
+ * @param filename Path to the output file
+ * @param matrix The matrix to write
+ * @param format File format, by default chosen by extension
+ * @throws std::runtime_error if the file cannot be opened/written
+ */
+void writeMatrix(const std::string& filename, const Eigen::MatrixXd& matrix,
+                 FileFormat format = FileFormat::Auto);
+
 /**
  * @brief Writes an augmented matrix to a CSV file
  * 
@@ -68,6 +219,31 @@ Eigen::MatrixXd generateRandomSystem(int num_variables,
  */
 void writeMatrixToCSV(const std::string& filename, const Eigen::MatrixXd& matrix);
 
+namespace detail {
+
+/**
+ * @brief Rows per chunk of a parallel pivot search. Scanning a chunk is
+ *        cheaper than waking a thread, so columns shorter than two chunks
+ *        are searched serially.
+ */
+constexpr int PIVOT_CHUNK_ROWS = 4096;
+
+/**
+ * @brief Partial pivoting: the row of the largest |A(i, k)| for i >= k, the
+ *        first one on ties. Columns of at least two chunks are searched as a
+ *        parallel reduction over getNumThreads() threads.
+ * 
+ * @param A The matrix being eliminated
+ * @param k The column (and first row) to search
+ * @param chunk_rows Rows per chunk; tests pass small chunks to reach the
+ *        parallel reduction on small matrices
+ * @return int The pivot row
+ */
+int findPivot(const Eigen::Ref<const Eigen::MatrixXd>& A, int k,
+              int chunk_rows = PIVOT_CHUNK_ROWS);
+
+} // namespace detail
+
 } // namespace GaussianSolver
 
 #endif // GAUSSIAN_ELIMINATION_HPP
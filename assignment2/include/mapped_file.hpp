@@ -0,0 +1,44 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace GaussianSolver {
+
+/**
+ * @brief A whole file mapped into memory, unmapped on destruction.
+ *
+ * The mapping is private and writable: changes stay in this process and
+ * never reach the file. Where mmap is unavailable the file is read into a
+ * buffer instead.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps the file.
+     *
+     * @param filename Path to the file
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> buffer_;
+};
+
+} // namespace GaussianSolver
+
+#endif // MAPPED_FILE_HPP
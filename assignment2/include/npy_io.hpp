@@ -0,0 +1,63 @@
+#ifndef NPY_IO_HPP
+#define NPY_IO_HPP
+
+#include "mapped_file.hpp"
+#include <Eigen/Dense>
+#include <memory>
+#include <string>
+
+namespace GaussianSolver {
+
+/**
+ * @brief A matrix stored in a NumPy .npy file (little-endian float64),
+ *        memory-mapped and viewed in place through an Eigen::Map.
+ *
+ * Files in Fortran (column-major) order, which writeMatrixToNpy produces, are
+ * used directly from the mapping. The mapping is private, so the matrix can be
+ * solved in place without changing the file. C-order files are copied once
+ * into column-major storage.
+ */
+class MappedMatrix {
+public:
+    /**
+     * @brief Maps the file and checks its header.
+     *
+     * @param filename Path to the .npy file
+     * @throws std::runtime_error if the file cannot be opened or is not a
+     *         2-D (or 1-D) little-endian float64 array
+     */
+    explicit MappedMatrix(const std::string& filename);
+
+    /** @brief The matrix; a 1-D array is a single column. */
+    Eigen::Map<Eigen::MatrixXd>& matrix() { return map_; }
+
+private:
+    std::unique_ptr<MappedFile> file_;
+    Eigen::MatrixXd copy_;
+    Eigen::Map<Eigen::MatrixXd> map_;
+};
+
+/**
+ * @brief Reads a matrix from a NumPy .npy file.
+ *
+ * @param filename Path to the .npy file
+ * @return Eigen::MatrixXd The matrix; a 1-D array is a single column
+ * @throws std::runtime_error if the file cannot be read or has an unsupported format
+ */
+Eigen::MatrixXd readMatrixFromNpy(const std::string& filename);
+
+/**
+ * @brief Writes a matrix to a NumPy .npy file as Fortran-order float64, with
+ *        the data 64-byte aligned so the file can be mapped by MappedMatrix.
+ *
+ * @param filename Path to the output .npy file
+ * @param matrix The matrix to write
+ * @param as_vector Store a single column as a 1-D array
+ * @throws std::runtime_error if the file cannot be opened/written
+ */
+void writeMatrixToNpy(const std::string& filename, const Eigen::MatrixXd& matrix,
+                      bool as_vector = false);
+
+} // namespace GaussianSolver
+
+#endif // NPY_IO_HPP
@@ -0,0 +1,39 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <functional>
+
+namespace GaussianSolver {
+
+/**
+ * @brief Sets the number of threads used by solve() and Factorization.
+ *
+ * The backend (OpenMP or a std::thread pool) is chosen at CMake configure
+ * time with the USE_OPENMP option. The solver splits the matrix products
+ * across its own threads, so Eigen and OpenBLAS are kept to one thread each.
+ *
+ * @param threads Number of threads; 0 uses every hardware thread
+ */
+void setNumThreads(int threads);
+
+/**
+ * @brief Returns the number of threads used by solve() and Factorization.
+ */
+int getNumThreads();
+
+namespace detail {
+
+/**
+ * @brief Splits [0, count) into contiguous ranges, one per thread, and runs
+ *        body(begin, end) for each of them, returning once all are done.
+ *
+ * Runs inline when there is a single thread or a single item. body must not
+ * throw.
+ */
+void parallelFor(int count, const std::function<void(int, int)>& body);
+
+} // namespace detail
+
+} // namespace GaussianSolver
+
+#endif // PARALLEL_HPP
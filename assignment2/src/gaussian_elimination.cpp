@@ -1,65 +1,204 @@
 #include "gaussian_elimination.hpp"
+#include "mapped_file.hpp"
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <random>
 #include <algorithm>
-#include <lazycsv.hpp>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <vector>
 
 namespace GaussianSolver {
 
-Eigen::MatrixXd readAugmentedMatrixFromCSV(const std::string& filename) {
-    std::vector<std::vector<double>> rows;
+namespace {
+
+// CSV files at least this big are parsed by several threads
+constexpr size_t PARALLEL_CSV_BYTES = size_t(1) << 20;
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// The '\n' ending the line that starts at p, or end
+const char* lineEnd(const char* p, const char* end) {
+    const void* newline = std::memchr(p, '\n', end - p);
+    return newline ? static_cast<const char*>(newline) : end;
+}
+
+// Start of the line after the one at p, or end
+const char* nextLine(const char* p, const char* end) {
+    const char* e = lineEnd(p, end);
+    return e < end ? e + 1 : end;
+}
+
+bool isBlankLine(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) {
+        ++p;
+    }
+    return p == end;
+}
+
+// Parses the number at the start of a cell, skipping blanks around it.
+// Returns the position after it, or nullptr if the cell is not a number.
+const char* parseCell(const char* p, const char* end, double& value) {
+    while (p < end && isBlank(*p)) {
+        ++p;
+    }
+    // from_chars takes no leading '+'
+    if (p < end && *p == '+') {
+        ++p;
+    }
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        return nullptr;
+    }
+    p = result.ptr;
+    while (p < end && isBlank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// A part of the file cut at line boundaries, parsed by one thread
+struct CsvChunk {
+    const char* begin;
+    const char* end;
+    size_t lines = 0;       // All lines, for error messages
+    size_t rows = 0;        // Non-blank lines
+    size_t first_line = 0;  // 1-based line number of begin
+    size_t first_row = 0;   // Matrix row of the first data line
+    std::string error{};
+};
+
+void countLines(CsvChunk& chunk) {
+    for (const char* p = chunk.begin; p < chunk.end; p = nextLine(p, chunk.end)) {
+        chunk.lines++;
+        chunk.rows += !isBlankLine(p, lineEnd(p, chunk.end));
+    }
+}
+
+// Parses the chunk's data lines straight into their rows of the matrix.
+// Errors are recorded in the chunk, since this runs on worker threads.
+void parseChunk(CsvChunk& chunk, Eigen::MatrixXd& matrix) {
+    Eigen::Index cols = matrix.cols();
+    Eigen::Index row = chunk.first_row;
+    size_t line = chunk.first_line;
     
-    try {
-        // Open the file manually first to see if it exists
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            throw std::runtime_error("Could not open file: " + filename);
-        }
-        file.close();
-        
-        // Use lazycsv to parse the CSV file
-        lazycsv::parser parser(filename);
-        
-        // Find the matrix dimensions
-        size_t num_rows = 0;
-        size_t num_cols = 0;
-        bool first_row = true;
-        
-        // Debug output
-        //std::cout << "Reading CSV rows:" << std::endl;
-        
-        for (const auto& row : parser) {
-            std::vector<double> current_row;
-            
-            for (const auto& cell : row) {
-                std::string cell_str = std::string(cell.raw());
-                current_row.push_back(std::stod(cell_str));
+    for (const char* p = chunk.begin; p < chunk.end; ++line) {
+        const char* e = lineEnd(p, chunk.end);
+        const char* next = nextLine(p, chunk.end);
+        if (isBlankLine(p, e)) {
+            p = next;
+            continue;
+        }
+        
+        Eigen::Index col = 0;
+        for (;;) {
+            double value;
+            p = col < cols ? parseCell(p, e, value) : nullptr;
+            if (p == nullptr || (p < e && *p != ',')) {
+                chunk.error = col < cols ? "Invalid number at line " + std::to_string(line)
+                                         : "Inconsistent number of columns at line " + 
+                                           std::to_string(line);
+                return;
             }
-            
-            // Check for consistent column count
-            if (first_row) {
-                num_cols = current_row.size();
-                first_row = false;
-            } else if (current_row.size() != num_cols) {
-                throw std::runtime_error("Inconsistent number of columns in CSV file: " + filename);
+            matrix(row, col++) = value;
+            if (p == e) {
+                break;
             }
-            
-            rows.push_back(current_row);
-            num_rows++;
+            ++p;
+        }
+        if (col != cols) {
+            chunk.error = "Inconsistent number of columns at line " + std::to_string(line);
+            return;
+        }
+        
+        ++row;
+        p = next;
+    }
+}
+
+} // anonymous namespace
+
+Eigen::MatrixXd readAugmentedMatrixFromCSV(const std::string& filename) {
+    try {
+        MappedFile file(filename);
+        const char* p = file.data();
+        const char* end = p + file.size();
+        
+        // Skip leading blank lines, then a header row if its first cell
+        // cannot start a number. A first cell that looks numeric but does
+        // not parse is an error on the data line, not a header.
+        size_t first_line = 1;
+        while (p < end && isBlankLine(p, lineEnd(p, end))) {
+            p = nextLine(p, end);
+            first_line++;
+        }
+        if (p == end) {
+            throw std::runtime_error("Empty or invalid matrix in CSV file: " + filename);
+        }
+        const char* cell = p;
+        while (isBlank(*cell)) {
+            ++cell;
+        }
+        if (!std::isdigit(static_cast<unsigned char>(*cell)) && *cell != '-' && *cell != '+' &&
+            *cell != '.') {
+            p = nextLine(p, end);
+            first_line++;
         }
         
-        if (num_rows == 0 || num_cols == 0) {
+        // Columns are counted on the first data line
+        const char* first = p;
+        while (first < end && isBlankLine(first, lineEnd(first, end))) {
+            first = nextLine(first, end);
+        }
+        if (first == end) {
             throw std::runtime_error("Empty or invalid matrix in CSV file: " + filename);
         }
+        const char* first_end = lineEnd(first, end);
+        Eigen::Index cols = 1 + std::count(first, first_end, ',');
+        
+        // Cut the data into one chunk per thread at line boundaries
+        size_t length = end - p;
+        int parts = length >= PARALLEL_CSV_BYTES ? getNumThreads() : 1;
+        std::vector<CsvChunk> chunks;
+        const char* begin = p;
+        for (int i = 1; i <= parts && begin < end; ++i) {
+            const char* cut = i == parts ? end : nextLine(p + length * i / parts, end);
+            if (cut > begin) {
+                chunks.push_back(CsvChunk{begin, cut});
+                begin = cut;
+            }
+        }
         
-        // Create the Eigen matrix
-        Eigen::MatrixXd matrix(num_rows, num_cols);
-        for (size_t i = 0; i < num_rows; ++i) {
-            for (size_t j = 0; j < num_cols; ++j) {
-                matrix(i, j) = rows[i][j];
+        // First pass: count lines so each chunk knows its first row
+        detail::parallelFor(static_cast<int>(chunks.size()), [&](int first_chunk, int last_chunk) {
+            for (int c = first_chunk; c < last_chunk; ++c) {
+                countLines(chunks[c]);
+            }
+        });
+        size_t rows = 0;
+        size_t line = first_line;
+        for (auto& chunk : chunks) {
+            chunk.first_row = rows;
+            chunk.first_line = line;
+            rows += chunk.rows;
+            line += chunk.lines;
+        }
+        
+        // Second pass: parse into the column-major matrix
+        Eigen::MatrixXd matrix(rows, cols);
+        detail::parallelFor(static_cast<int>(chunks.size()), [&](int first_chunk, int last_chunk) {
+            for (int c = first_chunk; c < last_chunk; ++c) {
+                parseChunk(chunks[c], matrix);
+            }
+        });
+        for (const auto& chunk : chunks) {
+            if (!chunk.error.empty()) {
+                throw std::runtime_error(chunk.error + " in CSV file: " + filename);
             }
         }
         
@@ -69,69 +208,197 @@ Eigen::MatrixXd readAugmentedMatrixFromCSV(const std::string& filename) {
     }
 }
 
-Eigen::VectorXd solve(const Eigen::MatrixXd& augmentedMatrix, double epsilon) {
-    // Get dimensions
-    int n = augmentedMatrix.rows();
+namespace detail {
+
+int findPivot(const Eigen::Ref<const Eigen::MatrixXd>& A, int k, int chunk_rows) {
+    int length = A.rows() - k;
+    int chunks = length / chunk_rows;
     
-    // Validate input matrix - should be augmented matrix [A|b]
-    if (augmentedMatrix.cols() != n + 1) {
-        throw std::invalid_argument("Augmented matrix should have n+1 columns for n equations");
+    if (chunks < 2 || getNumThreads() == 1) {
+        Eigen::Index offset;
+        A.col(k).tail(length).cwiseAbs().maxCoeff(&offset);
+        return k + static_cast<int>(offset);
     }
     
-    // Create a mutable copy of the matrix
-    Eigen::MatrixXd A = augmentedMatrix;
+    // Parallel reduction: the best row of each chunk, then the best chunk
+    std::vector<Eigen::Index> best(chunks);
+    parallelFor(chunks, [&](int begin, int end) {
+        for (int c = begin; c < end; ++c) {
+            int first = k + c * chunk_rows;
+            int rows = c == chunks - 1 ? A.rows() - first : chunk_rows;
+            Eigen::Index chunk_offset;
+            A.col(k).segment(first, rows).cwiseAbs().maxCoeff(&chunk_offset);
+            best[c] = first + chunk_offset;
+        }
+    });
     
-    // Forward Elimination with Partial Pivoting
-    for (int k = 0; k < n - 1; ++k) {
-        // Find the row with maximum absolute value in column k (partial pivoting)
-        int pivot_row = k;
-        double max_val = std::abs(A(k, k));
-        
-        for (int i = k + 1; i < n; ++i) {
-            if (std::abs(A(i, k)) > max_val) {
-                max_val = std::abs(A(i, k));
-                pivot_row = i;
-            }
+    Eigen::Index pivot_row = best[0];
+    for (int c = 1; c < chunks; ++c) {
+        if (std::abs(A(best[c], k)) > std::abs(A(pivot_row, k))) {
+            pivot_row = best[c];
         }
+    }
+    return static_cast<int>(pivot_row);
+}
+
+} // namespace detail
+
+namespace {
+
+// Columns per panel of the blocked factorization. Wide enough that the
+// trailing update is a proper GEMM, narrow enough that the unblocked panel
+// work (O(n * BLOCK_SIZE^2) per panel) stays small
+constexpr int BLOCK_SIZE = 128;
+
+// Trailing columns are handed out to threads in multiples of this width
+constexpr int TILE_COLS = 64;
+
+// Unblocked elimination of panel columns [k0, k0 + nb). Row swaps are
+// applied to the panel and the L columns left of it; the columns right of
+// the panel get them in updateTrailing. The multipliers are kept below the
+// diagonal (the L factor).
+void factorPanel(Eigen::Ref<Eigen::MatrixXd> A, int k0, int nb, Eigen::VectorXi& pivots,
+                 double epsilon) {
+    int n = A.rows();
+    int panel_end = k0 + nb;
+    
+    for (int k = k0; k < panel_end; ++k) {
+        // Partial pivoting: the column is contiguous in column-major storage
+        int pivot_row = detail::findPivot(A, k);
+        pivots(k) = pivot_row;
         
-        // Swap rows if needed
         if (pivot_row != k) {
-            A.row(k).swap(A.row(pivot_row));
+            A.row(k).head(panel_end).swap(A.row(pivot_row).head(panel_end));
         }
         
         // Check for singularity
         if (std::abs(A(k, k)) < epsilon) {
+            if (k == n - 1) {
+                throw SingularMatrixException("Matrix is singular or ill-conditioned at the last column");
+            }
             throw SingularMatrixException("Matrix is singular or ill-conditioned at column " + 
                                            std::to_string(k));
         }
         
-        // Perform elimination for all rows below pivot
-        for (int i = k + 1; i < n; ++i) {
-            double factor = A(i, k) / A(k, k);
-            A.row(i) -= factor * A.row(k);
+        // Multipliers, then a rank-1 update of the rest of the panel
+        int below = n - k - 1;
+        A.col(k).tail(below) /= A(k, k);
+        A.block(k + 1, k + 1, below, panel_end - k - 1).noalias() -=
+            A.col(k).tail(below) * A.row(k).segment(k + 1, panel_end - k - 1);
+    }
+}
+
+// Applies the panel [k0, k1) to the columns right of it. Every column is
+// independent, so they are split into tiles across threads, and each tile
+// gets its row swaps, U12 = L11^-1 A12 and A22 -= L21 U12 (one GEMM).
+void updateTrailing(Eigen::Ref<Eigen::MatrixXd> A, int k0, int k1,
+                    const Eigen::VectorXi& pivots) {
+    int n = A.rows();
+    int cols = A.cols();
+    int nb = k1 - k0;
+    int tiles = (cols - k1 + TILE_COLS - 1) / TILE_COLS;
+    
+    detail::parallelFor(tiles, [&](int begin, int end) {
+        int c0 = k1 + begin * TILE_COLS;
+        int width = std::min(cols, k1 + end * TILE_COLS) - c0;
+        
+        for (int k = k0; k < k1; ++k) {
+            if (pivots(k) != k) {
+                A.row(k).segment(c0, width).swap(A.row(pivots(k)).segment(c0, width));
+            }
+        }
+        
+        auto U12 = A.block(k0, c0, nb, width);
+        A.block(k0, k0, nb, nb).triangularView<Eigen::UnitLower>().solveInPlace(U12);
+        
+        if (k1 < n) {
+            A.block(k1, c0, n - k1, width).noalias() -= A.block(k1, k0, n - k1, nb) * U12;
+        }
+    });
+}
+
+// Blocked right-looking LU with partial pivoting of the leading n x n part of
+// A. Any columns right of it (right-hand sides) ride along, so they end up
+// as L^-1 P B. pivots(k) is the row swapped with row k at step k.
+void factorInPlace(Eigen::Ref<Eigen::MatrixXd> A, Eigen::VectorXi& pivots, double epsilon) {
+    int n = A.rows();
+    int cols = A.cols();
+    pivots.resize(n);
+    
+    for (int k0 = 0; k0 < n; k0 += BLOCK_SIZE) {
+        int nb = std::min(BLOCK_SIZE, n - k0);
+        
+        factorPanel(A, k0, nb, pivots, epsilon);
+        
+        if (k0 + nb < cols) {
+            updateTrailing(A, k0, k0 + nb, pivots);
         }
     }
+}
+
+} // anonymous namespace
+
+Eigen::VectorXd solve(const Eigen::MatrixXd& augmentedMatrix, double epsilon) {
+    // Get dimensions
+    int n = augmentedMatrix.rows();
     
-    // Check singularity of the last pivot
-    if (std::abs(A(n-1, n-1)) < epsilon) {
-        throw SingularMatrixException("Matrix is singular or ill-conditioned at the last column");
+    // Validate input matrix - should be augmented matrix [A|b]
+    if (augmentedMatrix.cols() != n + 1) {
+        throw std::invalid_argument("Augmented matrix should have n+1 columns for n equations");
     }
     
-    // Back Substitution
-    Eigen::VectorXd solution(n);
+    // Create a mutable copy of the matrix
+    Eigen::MatrixXd A = augmentedMatrix;
+    solveInPlace(A, epsilon);
     
-    for (int i = n - 1; i >= 0; --i) {
-        // Calculate the sum of known terms: sum(A(i,j) * solution(j)) for j > i
-        double sum = 0.0;
-        for (int j = i + 1; j < n; ++j) {
-            sum += A(i, j) * solution(j);
-        }
-        
-        // Solve for the current variable
-        solution(i) = (A(i, n) - sum) / A(i, i);
+    return A.col(n);
+}
+
+void solveInPlace(Eigen::Ref<Eigen::MatrixXd> augmentedMatrix, double epsilon) {
+    // Get dimensions
+    int n = augmentedMatrix.rows();
+    int num_rhs = augmentedMatrix.cols() - n;
+    
+    // Validate input matrix - should be augmented matrix [A|B]
+    if (num_rhs < 1) {
+        throw std::invalid_argument("Augmented matrix should have at least n+1 columns for n equations");
     }
     
-    return solution;
+    Eigen::VectorXi pivots;
+    factorInPlace(augmentedMatrix, pivots, epsilon);
+    
+    // Back Substitution on the upper triangle, over the right-hand sides
+    auto B = augmentedMatrix.rightCols(num_rhs);
+    augmentedMatrix.leftCols(n).triangularView<Eigen::Upper>().solveInPlace(B);
+}
+
+Factorization::Factorization(const Eigen::MatrixXd& A, double epsilon) : lu_(A) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("Coefficient matrix should be square");
+    }
+    factorInPlace(lu_, pivots_, epsilon);
+}
+
+Eigen::MatrixXd Factorization::solveColumns(const Eigen::Ref<const Eigen::MatrixXd>& B) const {
+    if (B.rows() != lu_.rows()) {
+        throw std::invalid_argument("Right-hand side should have one row per equation");
+    }
+    
+    // Replay the row swaps, then forward and back substitution. The
+    // right-hand sides are independent, so threads take column ranges.
+    Eigen::MatrixXd X = B;
+    detail::parallelFor(X.cols(), [&](int begin, int end) {
+        auto tile = X.middleCols(begin, end - begin);
+        for (int k = 0; k < pivots_.size(); ++k) {
+            if (pivots_(k) != k) {
+                tile.row(k).swap(tile.row(pivots_(k)));
+            }
+        }
+        lu_.triangularView<Eigen::UnitLower>().solveInPlace(tile);
+        lu_.triangularView<Eigen::Upper>().solveInPlace(tile);
+    });
+    
+    return X;
 }
 
 void writeSolutionToCSV(const std::string& filename, const Eigen::VectorXd& solution) {
@@ -153,6 +420,42 @@ void writeSolutionToCSV(const std::string& filename, const Eigen::VectorXd& solu
     file.close();
 }
 
+void writeSolutionToCSV(const std::string& filename, const Eigen::MatrixXd& solutions) {
+    if (solutions.cols() == 1) {
+        writeSolutionToCSV(filename, Eigen::VectorXd(solutions.col(0)));
+        return;
+    }
+    
+    std::ofstream file(filename);
+    if (!file) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+
+    // One column per right-hand side
+    for (int j = 0; j < solutions.cols(); ++j) {
+        file << "solution" << (j + 1);
+        if (j < solutions.cols() - 1) {
+            file << ",";
+        }
+    }
+    file << "\n";
+    
+    // Set precision for floating-point output
+    file << std::fixed << std::setprecision(10);
+    
+    for (int i = 0; i < solutions.rows(); ++i) {
+        for (int j = 0; j < solutions.cols(); ++j) {
+            file << solutions(i, j);
+            if (j < solutions.cols() - 1) {
+                file << ",";
+            }
+        }
+        file << std::endl;
+    }
+    
+    file.close();
+}
+
 Eigen::MatrixXd generateRandomSystem(int num_variables, double min_val, double max_val, 
                                      unsigned int seed) {
     if (num_variables <= 0) {
@@ -219,4 +522,47 @@ void writeMatrixToCSV(const std::string& filename, const Eigen::MatrixXd& matrix
     file.close();
 }
 
+FileFormat parseFileFormat(const std::string& name) {
+    if (name == "auto") {
+        return FileFormat::Auto;
+    } else if (name == "csv") {
+        return FileFormat::Csv;
+    } else if (name == "npy") {
+        return FileFormat::Npy;
+    }
+    throw std::invalid_argument("Unknown file format: " + name + " (expected auto, csv or npy)");
+}
+
+FileFormat resolveFileFormat(const std::string& filename, FileFormat format) {
+    if (format != FileFormat::Auto) {
+        return format;
+    }
+    bool npy = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".npy") == 0;
+    return npy ? FileFormat::Npy : FileFormat::Csv;
+}
+
+Eigen::MatrixXd readAugmentedMatrix(const std::string& filename, FileFormat format) {
+    if (resolveFileFormat(filename, format) == FileFormat::Npy) {
+        return readMatrixFromNpy(filename);
+    }
+    return readAugmentedMatrixFromCSV(filename);
+}
+
+void writeSolution(const std::string& filename, const Eigen::MatrixXd& solutions,
+                   FileFormat format) {
+    if (resolveFileFormat(filename, format) == FileFormat::Npy) {
+        writeMatrixToNpy(filename, solutions, true);
+    } else {
+        writeSolutionToCSV(filename, solutions);
+    }
+}
+
+void writeMatrix(const std::string& filename, const Eigen::MatrixXd& matrix, FileFormat format) {
+    if (resolveFileFormat(filename, format) == FileFormat::Npy) {
+        writeMatrixToNpy(filename, matrix);
+    } else {
+        writeMatrixToCSV(filename, matrix);
+    }
+}
+
 } // namespace GaussianSolver
@@ -3,17 +3,22 @@
 #include <string>
 #include <cstring>
 #include <chrono>
+#include <memory>
 
 void printUsage(const char* programName) {
     std::cout << "Usage: " << programName << " [options]\n"
               << "Options:\n"
               << "  --input <file>      Input CSV file containing the augmented matrix [A|b]\n"
-              << "  --output <file>     Output CSV file to write the solution vector\n"
+              << "                      (several b columns are solved with one factorization)\n"
+              << "  --output <file>     Output CSV file to write the solution vector(s)\n"
               << "  --generate <N>      Generate a random system of N equations\n"
               << "  --seed <S>          Seed for random number generator (default: current time)\n"
               << "  --min <val>         Minimum value for random coefficients (default: -10.0)\n"
               << "  --max <val>         Maximum value for random coefficients (default: 10.0)\n"
               << "  --matrix-out <file> Save the generated matrix to this file (only with --generate)\n"
+              << "  --threads <T>       Threads for reading and elimination (default: 0 = all cores)\n"
+              << "  --verify            Check the residual of the solution (keeps a copy of the matrix)\n"
+              << "  --format <fmt>      File format: auto (by extension, .npy or CSV), csv or npy\n"
               << "  --help              Display this help message\n";
 }
 
@@ -27,6 +32,9 @@ int main(int argc, char* argv[]) {
         std::chrono::high_resolution_clock::now().time_since_epoch().count());
     double minVal = -10.0;
     double maxVal = 10.0;
+    int numThreads = 0;
+    bool verify = false;
+    std::string formatName = "auto";
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -47,6 +55,12 @@ int main(int argc, char* argv[]) {
             maxVal = std::stod(argv[++i]);
         } else if (strcmp(argv[i], "--matrix-out") == 0 && i + 1 < argc) {
             matrixOutputFile = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            formatName = argv[++i];
         } else {
             std::cerr << "Unknown option: " << argv[i] << std::endl;
             printUsage(argv[0]);
@@ -62,17 +76,20 @@ int main(int argc, char* argv[]) {
     }
     
     try {
+        GaussianSolver::setNumThreads(numThreads);
+        GaussianSolver::FileFormat format = GaussianSolver::parseFileFormat(formatName);
         Eigen::MatrixXd augmentedMatrix;
+        std::unique_ptr<GaussianSolver::MappedMatrix> mappedMatrix;
         
         // Either read from file or generate random system
         if (!inputFile.empty()) {
             std::cout << "Reading augmented matrix from: " << inputFile << std::endl;
-            augmentedMatrix = GaussianSolver::readAugmentedMatrixFromCSV(inputFile);
-            
-            // Debug output
-            std::cout << "Raw matrix dimensions: " << augmentedMatrix.rows() << "x" 
-                      << augmentedMatrix.cols() << std::endl;
-            std::cout << "Matrix content:\n" << augmentedMatrix << std::endl;
+            if (GaussianSolver::resolveFileFormat(inputFile, format) == GaussianSolver::FileFormat::Npy) {
+                // Solved in its private mapping: no parsing and no copy
+                mappedMatrix = std::make_unique<GaussianSolver::MappedMatrix>(inputFile);
+            } else {
+                augmentedMatrix = GaussianSolver::readAugmentedMatrixFromCSV(inputFile);
+            }
         } else {
             std::cout << "Generating random " << generateSize << "x" << (generateSize + 1) 
                       << " augmented matrix with seed: " << seed << std::endl;
@@ -81,19 +98,40 @@ int main(int argc, char* argv[]) {
             // Save the generated matrix if requested
             if (!matrixOutputFile.empty()) {
                 std::cout << "Saving generated matrix to: " << matrixOutputFile << std::endl;
-                GaussianSolver::writeMatrixToCSV(matrixOutputFile, augmentedMatrix);
+                GaussianSolver::writeMatrix(matrixOutputFile, augmentedMatrix, format);
             }
         }
         
+        Eigen::Map<Eigen::MatrixXd> system = mappedMatrix ? mappedMatrix->matrix()
+            : Eigen::Map<Eigen::MatrixXd>(augmentedMatrix.data(), augmentedMatrix.rows(),
+                                          augmentedMatrix.cols());
+        
         // Display matrix dimensions
-        std::cout << "Matrix dimensions: " << augmentedMatrix.rows() << "x" 
-                  << augmentedMatrix.cols() << std::endl;
+        std::cout << "Matrix dimensions: " << system.rows() << "x" 
+                  << system.cols() << std::endl;
+        
+        int n = system.rows();
+        int numRhs = system.cols() - n;
+        if (numRhs < 1) {
+            throw std::invalid_argument("Augmented matrix needs at least one right-hand side column");
+        }
+        
+        // The elimination overwrites the matrix, so the original is only
+        // kept when the residual check needs it
+        Eigen::MatrixXd original;
+        if (verify) {
+            original = system;
+        }
         
         // Solve the system
-        std::cout << "Solving system using Gaussian Elimination..." << std::endl;
+        std::cout << "Solving system using Gaussian Elimination on " 
+                  << GaussianSolver::getNumThreads() << " thread(s)..." << std::endl;
+        if (numRhs > 1) {
+            std::cout << "Eliminating " << numRhs << " right-hand sides together" << std::endl;
+        }
         auto startTime = std::chrono::high_resolution_clock::now();
         
-        Eigen::VectorXd solution = GaussianSolver::solve(augmentedMatrix);
+        GaussianSolver::solveInPlace(system);
         
         auto endTime = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
@@ -102,16 +140,16 @@ int main(int argc, char* argv[]) {
         
         // Write solution to output file
         std::cout << "Writing solution to: " << outputFile << std::endl;
-        GaussianSolver::writeSolutionToCSV(outputFile, solution);
-        
-        // Verify result - calculate A*x and check against b
-        int n = augmentedMatrix.rows();
-        Eigen::MatrixXd A = augmentedMatrix.leftCols(n);
-        Eigen::VectorXd b = augmentedMatrix.col(n);
-        Eigen::VectorXd b_calculated = A * solution;
+        Eigen::MatrixXd solution = system.rightCols(numRhs);
+        GaussianSolver::writeSolution(outputFile, solution, format);
         
-        double maxError = (b - b_calculated).cwiseAbs().maxCoeff();
-        std::cout << "Maximum residual error: " << maxError << std::endl;
+        // Verify result - calculate A*X and check against B
+        if (verify) {
+            Eigen::MatrixXd b_calculated = original.leftCols(n) * solution;
+            
+            double maxError = (original.rightCols(numRhs) - b_calculated).cwiseAbs().maxCoeff();
+            std::cout << "Maximum residual error: " << maxError << std::endl;
+        }
         
         return 0;
     } catch (const std::exception& e) {
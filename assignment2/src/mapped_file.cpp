@@ -0,0 +1,66 @@
+#include "mapped_file.hpp"
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GAUSS_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define GAUSS_HAVE_MMAP 0
+#include <fstream>
+#endif
+
+namespace GaussianSolver {
+
+MappedFile::MappedFile(const std::string& filename) {
+#if GAUSS_HAVE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not read file size: " + filename);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+
+    // mmap rejects empty mappings; an empty file is simply no data
+    if (size_ > 0) {
+        void* address = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Could not map file: " + filename);
+        }
+        ::madvise(address, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<char*>(address);
+        mapped_ = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    buffer_.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(buffer_.data(), buffer_.size())) {
+        throw std::runtime_error("Could not read file: " + filename);
+    }
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if GAUSS_HAVE_MMAP
+    if (mapped_) {
+        ::munmap(data_, size_);
+    }
+#endif
+}
+
+} // namespace GaussianSolver
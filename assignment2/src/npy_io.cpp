@@ -0,0 +1,198 @@
+#include "npy_io.hpp"
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace GaussianSolver {
+
+namespace {
+
+const char NPY_MAGIC[] = "\x93NUMPY";
+constexpr size_t NPY_MAGIC_SIZE = 6;
+
+// The data is padded to this alignment, as NumPy does
+constexpr size_t NPY_ALIGNMENT = 64;
+
+bool isLittleEndian() {
+    uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+struct NpyHeader {
+    Eigen::Index rows = 0;
+    Eigen::Index cols = 0;
+    bool fortran_order = false;
+    size_t data_offset = 0;
+};
+
+// Text following `key` in the header dictionary, or throws
+std::string::size_type findKey(const std::string& dict, const std::string& key,
+                               const std::string& filename) {
+    auto at = dict.find("'" + key + "'");
+    if (at == std::string::npos) {
+        throw std::runtime_error("Missing '" + key + "' in .npy header: " + filename);
+    }
+    return at + key.size() + 2;
+}
+
+NpyHeader parseHeader(const char* data, size_t size, const std::string& filename) {
+    if (size < 10 || std::memcmp(data, NPY_MAGIC, NPY_MAGIC_SIZE) != 0) {
+        throw std::runtime_error("Not a .npy file: " + filename);
+    }
+
+    // Version 1 has a 2-byte header length, versions 2 and 3 a 4-byte one
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    size_t header_start, header_size;
+    if (bytes[6] == 1) {
+        header_start = 10;
+        header_size = bytes[8] | size_t(bytes[9]) << 8;
+    } else if ((bytes[6] == 2 || bytes[6] == 3) && size >= 12) {
+        header_start = 12;
+        header_size = bytes[8] | size_t(bytes[9]) << 8 | size_t(bytes[10]) << 16 |
+                      size_t(bytes[11]) << 24;
+    } else {
+        throw std::runtime_error("Unsupported .npy version in file: " + filename);
+    }
+    if (header_start + header_size > size) {
+        throw std::runtime_error("Truncated .npy header in file: " + filename);
+    }
+    std::string dict(data + header_start, header_size);
+
+    NpyHeader header;
+    header.data_offset = header_start + header_size;
+
+    auto descr = dict.find('\'', findKey(dict, "descr", filename) + 1);
+    if (descr == std::string::npos || dict.compare(descr, 5, "'<f8'") != 0) {
+        throw std::runtime_error("Only little-endian float64 (<f8) .npy files are supported: " +
+                                 filename);
+    }
+
+    auto order = findKey(dict, "fortran_order", filename);
+    auto value = dict.find_first_not_of(": ", order);
+    header.fortran_order = value != std::string::npos && dict.compare(value, 4, "True") == 0;
+
+    // (rows,) or (rows, cols)
+    auto open = dict.find('(', findKey(dict, "shape", filename));
+    auto close = dict.find(')', open);
+    if (open == std::string::npos || close == std::string::npos) {
+        throw std::runtime_error("Invalid shape in .npy header: " + filename);
+    }
+    std::vector<Eigen::Index> shape;
+    const char* p = dict.c_str() + open + 1;
+    const char* end = dict.c_str() + close;
+    while (p < end) {
+        char* next;
+        long long extent = std::strtoll(p, &next, 10);
+        if (next == p) {
+            break;
+        }
+        // The solver indexes rows and columns with int
+        if (extent < 0 || extent > INT_MAX) {
+            throw std::runtime_error("Invalid shape in .npy header: " + filename);
+        }
+        shape.push_back(static_cast<Eigen::Index>(extent));
+        p = next;
+        while (p < end && (*p == ',' || *p == ' ')) {
+            ++p;
+        }
+    }
+    if (shape.empty() || shape.size() > 2) {
+        throw std::runtime_error("Only 1-D and 2-D arrays are supported in .npy file: " + filename);
+    }
+    header.rows = shape[0];
+    header.cols = shape.size() == 2 ? shape[1] : 1;
+
+    // Compared by division so that a huge shape cannot wrap the product
+    size_t available = (size - header.data_offset) / sizeof(double);
+    if (header.cols != 0 && size_t(header.rows) > available / size_t(header.cols)) {
+        throw std::runtime_error("Truncated .npy data in file: " + filename);
+    }
+    return header;
+}
+
+} // anonymous namespace
+
+MappedMatrix::MappedMatrix(const std::string& filename) : map_(nullptr, 0, 0) {
+    if (!isLittleEndian()) {
+        throw std::runtime_error(".npy files are only supported on little-endian hosts");
+    }
+
+    file_ = std::make_unique<MappedFile>(filename);
+    NpyHeader header = parseHeader(file_->data(), file_->size(), filename);
+    char* data = file_->data() + header.data_offset;
+
+    // Column-major, aligned data is used where it lies; anything else is
+    // copied once into column-major storage
+    bool aligned = reinterpret_cast<uintptr_t>(data) % alignof(double) == 0;
+    if ((header.fortran_order || header.cols == 1) && aligned) {
+        new (&map_) Eigen::Map<Eigen::MatrixXd>(reinterpret_cast<double*>(data),
+                                                header.rows, header.cols);
+        return;
+    }
+
+    using RowMajorMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    copy_.resize(header.rows, header.cols);
+    if (header.fortran_order || header.cols == 1) {
+        std::memcpy(copy_.data(), data, copy_.size() * sizeof(double));
+    } else if (aligned) {
+        copy_ = Eigen::Map<const RowMajorMatrix>(reinterpret_cast<const double*>(data),
+                                                 header.rows, header.cols);
+    } else {
+        // Misaligned doubles cannot be read through a pointer; copy each one
+        for (Eigen::Index i = 0; i < header.rows; ++i) {
+            for (Eigen::Index j = 0; j < header.cols; ++j) {
+                std::memcpy(&copy_(i, j), data, sizeof(double));
+                data += sizeof(double);
+            }
+        }
+    }
+    file_.reset();
+    new (&map_) Eigen::Map<Eigen::MatrixXd>(copy_.data(), copy_.rows(), copy_.cols());
+}
+
+Eigen::MatrixXd readMatrixFromNpy(const std::string& filename) {
+    MappedMatrix mapped(filename);
+    return mapped.matrix();
+}
+
+void writeMatrixToNpy(const std::string& filename, const Eigen::MatrixXd& matrix,
+                      bool as_vector) {
+    if (!isLittleEndian()) {
+        throw std::runtime_error(".npy files are only supported on little-endian hosts");
+    }
+
+    std::string shape = as_vector && matrix.cols() == 1
+        ? "(" + std::to_string(matrix.rows()) + ",)"
+        : "(" + std::to_string(matrix.rows()) + ", " + std::to_string(matrix.cols()) + ")";
+    std::string dict = "{'descr': '<f8', 'fortran_order': True, 'shape': " + shape + ", }";
+
+    // Pad with spaces and a newline so the data starts aligned
+    size_t unpadded = 10 + dict.size() + 1;
+    dict.append((NPY_ALIGNMENT - unpadded % NPY_ALIGNMENT) % NPY_ALIGNMENT, ' ');
+    dict += '\n';
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+
+    char preamble[10] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0,
+                         static_cast<char>(dict.size() & 0xFF),
+                         static_cast<char>(dict.size() >> 8)};
+    file.write(preamble, sizeof(preamble));
+    file.write(dict.data(), dict.size());
+    file.write(reinterpret_cast<const char*>(matrix.data()), matrix.size() * sizeof(double));
+
+    if (!file) {
+        throw std::runtime_error("Failed to write file: " + filename);
+    }
+}
+
+} // namespace GaussianSolver
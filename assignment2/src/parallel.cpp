@@ -0,0 +1,181 @@
+#include "parallel.hpp"
+#include <Eigen/Core>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#ifdef GAUSS_USE_OPENMP
+#include <omp.h>
+#else
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#endif
+
+#ifdef GAUSS_HAVE_OPENBLAS_THREADS
+extern "C" void openblas_set_num_threads(int num_threads);
+#endif
+
+namespace GaussianSolver {
+
+namespace {
+
+std::atomic<int> num_threads{1};
+
+int hardwareThreads() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Every thread of the solver runs its own GEMM, so the products must not
+// start threads of their own: that would put threads x BLAS threads on the
+// cores, and one solver thread would not mean one core
+void pinLibraryThreads() {
+    static std::once_flag pinned;
+    std::call_once(pinned, [] {
+        Eigen::setNbThreads(1);
+#ifdef GAUSS_HAVE_OPENBLAS_THREADS
+        openblas_set_num_threads(1);
+#endif
+    });
+}
+
+#ifndef GAUSS_USE_OPENMP
+
+// Fixed set of workers woken once per job, so a pivot search or a panel
+// update does not pay for creating threads
+class ThreadPool {
+public:
+    explicit ThreadPool(int workers) {
+        for (int i = 1; i <= workers; ++i) {
+            threads_.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    int size() const { return static_cast<int>(threads_.size()) + 1; }
+
+    // Runs job(part) for part in [0, parts); part 0 runs on the caller
+    void run(int parts, const std::function<void(int)>& job) {
+        std::lock_guard<std::mutex> serial(run_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            parts_ = parts;
+            pending_ = static_cast<int>(threads_.size());
+            ++generation_;
+        }
+        start_.notify_all();
+
+        job(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+private:
+    void work(int index) {
+        unsigned seen = 0;
+        for (;;) {
+            const std::function<void(int)>* job;
+            int parts;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+                job = job_;
+                parts = parts_;
+            }
+
+            if (index < parts) {
+                (*job)(index);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex run_mutex_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const std::function<void(int)>* job_ = nullptr;
+    int parts_ = 0;
+    int pending_ = 0;
+    unsigned generation_ = 0;
+    bool stop_ = false;
+};
+
+std::mutex pool_mutex;
+std::shared_ptr<ThreadPool> pool;
+
+// The pool sized for the current thread count, rebuilt when it changes
+std::shared_ptr<ThreadPool> currentPool(int threads) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (!pool || pool->size() != threads) {
+        pool = std::make_shared<ThreadPool>(threads - 1);
+    }
+    return pool;
+}
+
+#endif
+
+} // anonymous namespace
+
+void setNumThreads(int threads) {
+    pinLibraryThreads();
+    num_threads = threads > 0 ? threads : hardwareThreads();
+}
+
+int getNumThreads() {
+    return num_threads;
+}
+
+namespace detail {
+
+void parallelFor(int count, const std::function<void(int, int)>& body) {
+    pinLibraryThreads();
+    int parts = std::min(count, getNumThreads());
+    if (parts <= 1) {
+        if (count > 0) {
+            body(0, count);
+        }
+        return;
+    }
+
+    auto runPart = [&](int part) {
+        int begin = static_cast<int>(static_cast<long long>(count) * part / parts);
+        int end = static_cast<int>(static_cast<long long>(count) * (part + 1) / parts);
+        body(begin, end);
+    };
+
+#ifdef GAUSS_USE_OPENMP
+    #pragma omp parallel for num_threads(parts) schedule(static, 1)
+    for (int part = 0; part < parts; ++part) {
+        runPart(part);
+    }
+#else
+    currentPool(getNumThreads())->run(parts, runPart);
+#endif
+}
+
+} // namespace detail
+
+} // namespace GaussianSolver
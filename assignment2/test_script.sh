@@ -58,7 +58,7 @@ fi
 
 # Generate and solve a larger random system
 echo -e "\nGenerating and solving a 20x20 random system:"
-./build/gauss_solver --generate 20 --seed 42 --matrix-out random_system.csv --output random_solution.csv
+./build/gauss_solver --generate 20 --seed 42 --matrix-out random_system.csv --output random_solution.csv --verify
 
 echo "Completed random system test."
 
@@ -29,7 +29,7 @@ std::string createTempCSVFile(const std::vector<std::vector<double>>& data) {
         throw std::runtime_error("Failed to create temporary file: " + filename);
     }
     
-    // Add a dynamic dummy header for lazycsv
+    // Add a dynamic dummy header, as writeMatrixToCSV does
     if (!data.empty() && !data[0].empty()) {
         for (size_t i = 0; i < data[0].size(); ++i) {
             file << "col" << (i + 1);
@@ -157,6 +157,68 @@ TEST_F(GaussianEliminationTest, ReadInvalidCSV) {
     deleteTempFile(filename);
 }
 
+// Test the reader on files without a header, with blank lines, CRLF endings
+// and signed or exponent numbers
+TEST_F(GaussianEliminationTest, ReadCSVFormatting) {
+    std::string filename = "test_formatting.csv";
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << "\n1, +2.5 ,-3e2\r\n\n  4,5,6\r\n7,8,9";
+    }
+    
+    Eigen::MatrixXd matrix = GaussianSolver::readAugmentedMatrixFromCSV(filename);
+    Eigen::MatrixXd expected(3, 3);
+    expected << 1, 2.5, -300,
+                4, 5, 6,
+                7, 8, 9;
+    EXPECT_EQ(matrix, expected);
+    
+    // Errors name the line they occur on
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << "a,b,c\n1,2,3\n4,x,6\n";
+    }
+    try {
+        GaussianSolver::readAugmentedMatrixFromCSV(filename);
+        FAIL() << "Expected std::runtime_error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("line 3"), std::string::npos) << e.what();
+    }
+    
+    // A bad number on the first line is an error, not a header
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << "1e400,2,3\n4,5,6\n";
+    }
+    try {
+        GaussianSolver::readAugmentedMatrixFromCSV(filename);
+        FAIL() << "Expected std::runtime_error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("line 1"), std::string::npos) << e.what();
+    }
+    
+    deleteTempFile(filename);
+}
+
+// Test that a file big enough to be parsed in parallel reads back exactly
+TEST_F(GaussianEliminationTest, ReadLargeCSVInParallel) {
+    std::string filename = "test_large_matrix.csv";
+    Eigen::MatrixXd matrix = GaussianSolver::generateRandomSystem(300, -10.0, 10.0, 17);
+    GaussianSolver::writeMatrixToCSV(filename, matrix);
+    
+    Eigen::MatrixXd serial = GaussianSolver::readAugmentedMatrixFromCSV(filename);
+    GaussianSolver::setNumThreads(4);
+    Eigen::MatrixXd parallel = GaussianSolver::readAugmentedMatrixFromCSV(filename);
+    GaussianSolver::setNumThreads(1);
+    
+    ASSERT_EQ(parallel.rows(), 300);
+    ASSERT_EQ(parallel.cols(), 301);
+    EXPECT_EQ(parallel, serial);
+    EXPECT_LT((parallel - matrix).cwiseAbs().maxCoeff(), 1e-9);
+    
+    deleteTempFile(filename);
+}
+
 // Test solving a simple system
 TEST_F(GaussianEliminationTest, SolveSimpleSystem) {
     Eigen::MatrixXd matrix = createSimpleSystem();
@@ -263,6 +325,283 @@ TEST_F(GaussianEliminationTest, RandomSystemSolveVerify) {
     EXPECT_TRUE(areVectorsClose(b, b_calculated, 1e-6));
 }
 
+// Test a system spanning several elimination panels with a known solution
+TEST_F(GaussianEliminationTest, LargeSystemAcrossPanels) {
+    int size = 300;
+    Eigen::MatrixXd augmentedMatrix = GaussianSolver::generateRandomSystem(size, -10.0, 10.0, 7);
+    Eigen::VectorXd expected_solution = Eigen::VectorXd::LinSpaced(size, -1.0, 1.0);
+    augmentedMatrix.col(size) = augmentedMatrix.leftCols(size) * expected_solution;
+    
+    Eigen::VectorXd solution = GaussianSolver::solve(augmentedMatrix);
+    
+    EXPECT_TRUE(areVectorsClose(solution, expected_solution, 1e-8));
+}
+
+// Test that a dependent column past the first panel is reported where it occurs
+TEST_F(GaussianEliminationTest, SingularColumnInLaterPanel) {
+    int size = 200;
+    Eigen::MatrixXd matrix = GaussianSolver::generateRandomSystem(size, -10.0, 10.0, 11);
+    matrix.col(150) = 2.0 * matrix.col(3);
+    
+    try {
+        GaussianSolver::solve(matrix);
+        FAIL() << "Expected SingularMatrixException";
+    } catch (const GaussianSolver::SingularMatrixException& e) {
+        EXPECT_NE(std::string(e.what()).find("column 150"), std::string::npos) << e.what();
+    }
+}
+
+// Test reusing one factorization for several right-hand sides
+TEST_F(GaussianEliminationTest, FactorizationSolvesManyRightHandSides) {
+    int size = 200;
+    int num_rhs = 4;
+    Eigen::MatrixXd A = GaussianSolver::generateRandomSystem(size, -10.0, 10.0, 21).leftCols(size);
+    Eigen::MatrixXd X = GaussianSolver::generateRandomSystem(size, -1.0, 1.0, 22).leftCols(num_rhs);
+    Eigen::MatrixXd B = A * X;
+    
+    GaussianSolver::Factorization lu(A);
+    EXPECT_EQ(lu.size(), size);
+    
+    Eigen::MatrixXd solutions = lu.solve(B);
+    ASSERT_EQ(solutions.cols(), num_rhs);
+    for (int j = 0; j < num_rhs; ++j) {
+        EXPECT_TRUE(areVectorsClose(solutions.col(j), X.col(j)));
+        
+        // Single vectors agree with the augmented solver
+        Eigen::MatrixXd augmentedMatrix(size, size + 1);
+        augmentedMatrix << A, B.col(j);
+        Eigen::VectorXd solution = lu.solve(B.col(j));
+        EXPECT_TRUE(areVectorsClose(solution, GaussianSolver::solve(augmentedMatrix)));
+    }
+    
+    // Column blocks and plain vectors go straight in
+    Eigen::MatrixXd middle = lu.solve(B.middleCols(1, 2));
+    EXPECT_LT((middle - X.middleCols(1, 2)).cwiseAbs().maxCoeff(), 1e-10);
+    Eigen::VectorXd b = B.col(0);
+    EXPECT_TRUE(areVectorsClose(lu.solve(b), X.col(0)));
+    
+    EXPECT_THROW(lu.solve(Eigen::VectorXd(size + 1)), std::invalid_argument);
+    EXPECT_THROW(lu.solve(B.topRows(size - 1)), std::invalid_argument);
+}
+
+// Test that a factorization rejects singular and non-square matrices
+TEST_F(GaussianEliminationTest, FactorizationRejectsBadMatrices) {
+    Eigen::MatrixXd singular = createSingularSystem().leftCols(2);
+    EXPECT_THROW(GaussianSolver::Factorization{singular}, GaussianSolver::SingularMatrixException);
+    
+    EXPECT_THROW(GaussianSolver::Factorization{createSimpleSystem()}, std::invalid_argument);
+}
+
+// Test reading a system with several right-hand side columns
+TEST_F(GaussianEliminationTest, ReadMultipleRightHandSides) {
+    std::vector<std::vector<double>> data = {
+        {2.0, 1.0, 5.0, 3.0},
+        {1.0, 3.0, 10.0, 4.0}
+    };
+    
+    std::string filename = createTempCSVFile(data);
+    
+    try {
+        Eigen::MatrixXd matrix = GaussianSolver::readAugmentedMatrixFromCSV(filename);
+        ASSERT_EQ(matrix.rows(), 2);
+        ASSERT_EQ(matrix.cols(), 4);
+        
+        GaussianSolver::Factorization lu(matrix.leftCols(2));
+        Eigen::MatrixXd solutions = lu.solve(matrix.rightCols(2));
+        
+        EXPECT_NEAR(solutions(0, 0), 1.0, 1e-10);
+        EXPECT_NEAR(solutions(1, 0), 3.0, 1e-10);
+        EXPECT_NEAR(solutions(0, 1), 1.0, 1e-10);
+        EXPECT_NEAR(solutions(1, 1), 1.0, 1e-10);
+    } catch(const std::exception& e) {
+        deleteTempFile(filename);
+        FAIL() << "Exception thrown: " << e.what();
+    }
+    
+    deleteTempFile(filename);
+}
+
+// Test that the threaded elimination gives the serial results
+TEST_F(GaussianEliminationTest, ParallelSolveMatchesSerial) {
+    int size = 300;
+    Eigen::MatrixXd augmentedMatrix = GaussianSolver::generateRandomSystem(size, -10.0, 10.0, 5);
+    Eigen::MatrixXd B = GaussianSolver::generateRandomSystem(size, -10.0, 10.0, 6).leftCols(7);
+    
+    Eigen::VectorXd serial_solution = GaussianSolver::solve(augmentedMatrix);
+    Eigen::MatrixXd serial_solutions = GaussianSolver::Factorization(augmentedMatrix.leftCols(size)).solve(B);
+    
+    GaussianSolver::setNumThreads(4);
+    EXPECT_EQ(GaussianSolver::getNumThreads(), 4);
+    Eigen::VectorXd solution = GaussianSolver::solve(augmentedMatrix);
+    Eigen::MatrixXd solutions = GaussianSolver::Factorization(augmentedMatrix.leftCols(size)).solve(B);
+    GaussianSolver::setNumThreads(1);
+    
+    EXPECT_TRUE(areVectorsClose(solution, serial_solution, 1e-10));
+    EXPECT_LT((solutions - serial_solutions).cwiseAbs().maxCoeff(), 1e-10);
+}
+
+// Test the parallel pivot reduction against the serial search, using small
+// chunks so it runs without a huge matrix
+TEST_F(GaussianEliminationTest, ParallelPivotMatchesSerial) {
+    int rows = 1000;
+    int chunk_rows = 64;
+    Eigen::MatrixXd A = GaussianSolver::generateRandomSystem(rows, -10.0, 10.0, 11);
+    
+    // Column 1: the largest magnitude appears twice, in different chunks
+    A(300, 1) = -50.0;
+    A(900, 1) = 50.0;
+    // Column 2: the largest value sits in the short last chunk
+    A(rows - 1, 2) = 100.0;
+    
+    for (int k : {0, 1, 2, 3, 70}) {
+        int serial_pivot = GaussianSolver::detail::findPivot(A, k, chunk_rows);
+        GaussianSolver::setNumThreads(4);
+        int pivot = GaussianSolver::detail::findPivot(A, k, chunk_rows);
+        GaussianSolver::setNumThreads(1);
+        
+        EXPECT_EQ(pivot, serial_pivot) << "column " << k;
+    }
+    
+    GaussianSolver::setNumThreads(4);
+    EXPECT_EQ(GaussianSolver::detail::findPivot(A, 1, chunk_rows), 300);
+    EXPECT_EQ(GaussianSolver::detail::findPivot(A, 2, chunk_rows), rows - 1);
+    GaussianSolver::setNumThreads(1);
+}
+
+// Test solving in the caller's matrix, including a block of a larger one
+TEST_F(GaussianEliminationTest, SolveInPlace) {
+    int size = 150;
+    Eigen::MatrixXd augmentedMatrix = GaussianSolver::generateRandomSystem(size, -10.0, 10.0, 9);
+    Eigen::VectorXd expected_solution = GaussianSolver::solve(augmentedMatrix);
+    
+    Eigen::MatrixXd matrix = augmentedMatrix;
+    GaussianSolver::solveInPlace(matrix);
+    EXPECT_TRUE(areVectorsClose(matrix.col(size), expected_solution));
+    
+    // Two right-hand sides inside a bigger buffer (non-contiguous columns)
+    Eigen::MatrixXd buffer = Eigen::MatrixXd::Zero(size + 10, size + 5);
+    buffer.block(5, 1, size, size + 1) = augmentedMatrix;
+    buffer.block(5, size + 2, size, 1) = 2.0 * augmentedMatrix.col(size);
+    GaussianSolver::solveInPlace(buffer.block(5, 1, size, size + 2));
+    EXPECT_TRUE(areVectorsClose(buffer.block(5, size + 1, size, 1), expected_solution));
+    EXPECT_TRUE(areVectorsClose(buffer.block(5, size + 2, size, 1), 2.0 * expected_solution));
+    EXPECT_EQ(buffer.topRows(5).cwiseAbs().maxCoeff(), 0.0);
+    
+    Eigen::MatrixXd square = augmentedMatrix.leftCols(size);
+    EXPECT_THROW(GaussianSolver::solveInPlace(square), std::invalid_argument);
+    
+    Eigen::MatrixXd singular = createSingularSystem();
+    EXPECT_THROW(GaussianSolver::solveInPlace(singular), GaussianSolver::SingularMatrixException);
+}
+
+// Test .npy round trips for matrices and vectors
+TEST_F(GaussianEliminationTest, NpyRoundTrip) {
+    std::string filename = "test_matrix.npy";
+    Eigen::MatrixXd matrix = GaussianSolver::generateRandomSystem(7, -10.0, 10.0, 31);
+    
+    GaussianSolver::writeMatrix(filename, matrix);
+    EXPECT_EQ(GaussianSolver::readAugmentedMatrix(filename), matrix);
+    
+    // The data starts 64-byte aligned, as in files written by NumPy
+    EXPECT_EQ((fs::file_size(filename) - matrix.size() * sizeof(double)) % 64, 0u);
+    
+    Eigen::MatrixXd solution = matrix.col(0);
+    GaussianSolver::writeSolution(filename, solution);
+    Eigen::MatrixXd vector = GaussianSolver::readMatrixFromNpy(filename);
+    EXPECT_EQ(vector, solution);
+    
+    // Row-major (C order) files, as NumPy writes by default, are transposed on load
+    {
+        std::string header = "{'descr': '<f8', 'fortran_order': False, 'shape': (2, 3), }";
+        header.append(128 - 10 - header.size() - 1, ' ');
+        header += '\n';
+        double values[] = {1, 2, 3, 4, 5, 6};
+        std::ofstream file(filename, std::ios::binary);
+        file.write("\x93NUMPY\x01\x00", 8);
+        file.put(static_cast<char>(header.size())).put(0);
+        file.write(header.data(), header.size());
+        file.write(reinterpret_cast<const char*>(values), sizeof(values));
+    }
+    Eigen::MatrixXd expected(2, 3);
+    expected << 1, 2, 3,
+                4, 5, 6;
+    EXPECT_EQ(GaussianSolver::readMatrixFromNpy(filename), expected);
+    
+    // CSV content is not a .npy file
+    GaussianSolver::writeMatrixToCSV(filename, expected);
+    EXPECT_THROW(GaussianSolver::readMatrixFromNpy(filename), std::runtime_error);
+    
+    deleteTempFile(filename);
+}
+
+// Test that malformed .npy shapes are rejected before any data is read
+TEST_F(GaussianEliminationTest, NpyRejectsMalformedShape) {
+    std::string filename = "test_malformed.npy";
+    auto writeNpy = [&](const std::string& shape, size_t data_offset) {
+        std::string header = "{'descr': '<f8', 'fortran_order': False, 'shape': " + shape + ", }";
+        header.append(data_offset - 10 - header.size() - 1, ' ');
+        header += '\n';
+        double values[] = {1, 2, 3, 4, 5, 6};
+        std::ofstream file(filename, std::ios::binary);
+        file.write("\x93NUMPY\x01\x00", 8);
+        file.put(static_cast<char>(header.size())).put(0);
+        file.write(header.data(), header.size());
+        file.write(reinterpret_cast<const char*>(values), sizeof(values));
+    };
+    
+    // rows * cols * 8 would wrap to zero in 64 bits
+    writeNpy("(1073741824, 2147483648)", 128);
+    EXPECT_THROW(GaussianSolver::readMatrixFromNpy(filename), std::runtime_error);
+    writeNpy("(2147483647, 2147483647)", 128);
+    EXPECT_THROW(GaussianSolver::readMatrixFromNpy(filename), std::runtime_error);
+    writeNpy("(2147483648, 1)", 128);
+    EXPECT_THROW(GaussianSolver::readMatrixFromNpy(filename), std::runtime_error);
+    writeNpy("(-2, 3)", 128);
+    EXPECT_THROW(GaussianSolver::readMatrixFromNpy(filename), std::runtime_error);
+    writeNpy("(3, 3)", 128);
+    EXPECT_THROW(GaussianSolver::readMatrixFromNpy(filename), std::runtime_error);
+    
+    // Valid C-order data that does not start on a double boundary
+    writeNpy("(2, 3)", 131);
+    Eigen::MatrixXd expected(2, 3);
+    expected << 1, 2, 3,
+                4, 5, 6;
+    EXPECT_EQ(GaussianSolver::readMatrixFromNpy(filename), expected);
+    
+    deleteTempFile(filename);
+}
+
+// Test solving a mapped .npy system in place without touching the file
+TEST_F(GaussianEliminationTest, NpySolveMappedInPlace) {
+    std::string filename = "test_system.npy";
+    Eigen::MatrixXd augmentedMatrix = GaussianSolver::generateRandomSystem(40, -10.0, 10.0, 32);
+    GaussianSolver::writeMatrixToNpy(filename, augmentedMatrix);
+    
+    {
+        GaussianSolver::MappedMatrix mapped(filename);
+        ASSERT_EQ(mapped.matrix().rows(), 40);
+        ASSERT_EQ(mapped.matrix().cols(), 41);
+        GaussianSolver::solveInPlace(mapped.matrix());
+        EXPECT_TRUE(areVectorsClose(mapped.matrix().col(40), GaussianSolver::solve(augmentedMatrix)));
+    }
+    
+    EXPECT_EQ(GaussianSolver::readMatrixFromNpy(filename), augmentedMatrix);
+    
+    deleteTempFile(filename);
+}
+
+// Test choosing formats by name and extension
+TEST_F(GaussianEliminationTest, FileFormatSelection) {
+    using GaussianSolver::FileFormat;
+    EXPECT_EQ(GaussianSolver::resolveFileFormat("system.npy", FileFormat::Auto), FileFormat::Npy);
+    EXPECT_EQ(GaussianSolver::resolveFileFormat("system.csv", FileFormat::Auto), FileFormat::Csv);
+    EXPECT_EQ(GaussianSolver::resolveFileFormat("npy", FileFormat::Auto), FileFormat::Csv);
+    EXPECT_EQ(GaussianSolver::resolveFileFormat("system.csv", FileFormat::Npy), FileFormat::Npy);
+    EXPECT_EQ(GaussianSolver::parseFileFormat("csv"), FileFormat::Csv);
+    EXPECT_EQ(GaussianSolver::parseFileFormat("npy"), FileFormat::Npy);
+    EXPECT_THROW(GaussianSolver::parseFileFormat("xml"), std::invalid_argument);
+}
+
 // Test writing a matrix to CSV
 TEST_F(GaussianEliminationTest, WriteMatrixToCSV) {
     Eigen::MatrixXd matrix(2, 3);